@@ -0,0 +1,459 @@
+/**
+ * @file auto_tuner.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the auto-tuner
+ * every pool gets one worker per CPU the process may run on, and is
+ * measured on three things: the cost per task of a spawn tree, the best of
+ * a few rounds; the time a task spawned by a worker waits for another one
+ * to take it; and the time an idle pool takes to start an external task,
+ * both medians; the pools that hand off and wake up within
+ * AUTO_TUNE_SLACK of the best are eligible, the cheapest spawn of them wins
+ * the winner is then measured with half and with twice as many workers,
+ * and keeps the thread count of its cheapest spawn tree
+ */
+
+#include "auto_tuner.h"
+
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "global_pool.h"
+#include "local_coarse_pool.h"
+#include "local_fine_pool.h"
+#include "local_fine_pool_log_steal.h"
+#include "local_fine_pool_naive_steal.h"
+
+namespace {
+
+const PoolKind kPoolKinds[] = {PoolKind::GLOBAL,      PoolKind::LOCAL_COARSE,
+                               PoolKind::LOCAL_FINE,  PoolKind::LOG_STEAL,
+                               PoolKind::NAIVE_STEAL, PoolKind::NAIVE_STEAL_LIFO};
+
+using Clock = std::chrono::steady_clock;
+
+auto NanosSince(Clock::time_point start, Clock::time_point end) -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count());
+}
+
+auto Median(std::vector<uint64_t> values) -> uint64_t {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+auto NewPool(PoolKind kind, int threads, PoolType pool_type)
+    -> std::unique_ptr<BasePool> {
+  switch (kind) {
+    case PoolKind::GLOBAL:
+      return std::make_unique<GlobalPool>(threads, pool_type);
+    case PoolKind::LOCAL_COARSE:
+      return std::make_unique<LocalCoarsePool>(threads, pool_type);
+    case PoolKind::LOCAL_FINE:
+      return std::make_unique<LocalFinePool>(threads, pool_type);
+    case PoolKind::LOG_STEAL:
+      return std::make_unique<LocalFinePoolLogSteal>(threads, pool_type);
+    case PoolKind::NAIVE_STEAL:
+      return std::make_unique<LocalFinePoolNaiveSteal>(threads, pool_type);
+    case PoolKind::NAIVE_STEAL_LIFO:
+      return std::make_unique<LocalFinePoolNaiveSteal>(threads, pool_type,
+                                                       StealOrder::LIFO);
+  }
+  return nullptr;
+}
+
+/* --- the machine --- */
+
+auto CpuCount() -> int {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    return std::max(1, CPU_COUNT(&set));
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/* "48K", "2048K", "32M" as in /sys */
+auto ParseSize(const std::string& text) -> size_t {
+  size_t size = 0;
+  size_t i = 0;
+  while (i < text.size() && isdigit(static_cast<unsigned char>(text[i]))) {
+    size = size * 10 + (text[i++] - '0');
+  }
+  if (i < text.size()) {
+    switch (text[i]) {
+      case 'K':
+        return size << 10;
+      case 'M':
+        return size << 20;
+      case 'G':
+        return size << 30;
+    }
+  }
+  return size;
+}
+
+auto ReadLine(const std::string& path) -> std::string {
+  std::ifstream in(path);
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+/* the data caches of CPU 0, left 0 where /sys does not tell */
+void ReadCaches(TuneResult& result) {
+  int highest = 0;
+  for (int index = 0;; index++) {
+    std::string dir =
+        "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index);
+    std::string level = ReadLine(dir + "/level");
+    if (level.empty()) {
+      break;
+    }
+    if (ReadLine(dir + "/type") == "Instruction") {
+      continue;
+    }
+    int at = atoi(level.c_str());
+    size_t size = ParseSize(ReadLine(dir + "/size"));
+    if (at == 1) {
+      result.l1d_bytes = size;
+    } else if (at == 2) {
+      result.l2_bytes = size;
+    }
+    if (at >= highest) {
+      highest = at;
+      result.llc_bytes = size;
+    }
+  }
+}
+
+/* FNV-1a of the CPU model, the CPU count and the caches */
+auto MachineOf(const TuneResult& caches, int cpus) -> uint64_t {
+  std::string model;
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  for (std::string line; std::getline(cpuinfo, line);) {
+    if (line.rfind("model name", 0) == 0) {
+      model = line;
+      break;
+    }
+  }
+  std::ostringstream key;
+  key << model << "/" << cpus << "/" << caches.l1d_bytes << "/"
+      << caches.l2_bytes << "/" << caches.llc_bytes;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : key.str()) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/* --- the measurements --- */
+
+/* a full binary tree of spawns, one child submitted, the other inline */
+void SpawnTree(BasePool* pool, int depth) {
+  if (depth <= 1) {
+    return;
+  }
+  pool->Spawn([pool, depth]() { SpawnTree(pool, depth - 1); },
+              [pool, depth]() { SpawnTree(pool, depth - 1); });
+}
+
+auto MeasureSpawn(BasePool& pool) -> uint64_t {
+  // the root and one child per inner node are submitted
+  const uint64_t tasks = uint64_t(1) << (AUTO_TUNE_TREE_DEPTH - 1);
+  uint64_t best = UINT64_MAX;
+  for (int round = 0; round < AUTO_TUNE_ROUNDS; round++) {
+    auto start = Clock::now();
+    pool.Submit([&pool]() { SpawnTree(&pool, AUTO_TUNE_TREE_DEPTH); });
+    pool.WaitUntilFinished();
+    best = std::min(best, NanosSince(start, Clock::now()) / tasks);
+  }
+  return best;
+}
+
+/*
+ * A task spawns a child and waits for it, so another worker has to take it,
+ * by a steal or from a shared queue; a pool that cannot hand it off at all
+ * runs into the timeout, and is charged with it
+ */
+auto MeasureHandoff(BasePool& pool) -> uint64_t {
+  // a single worker has nobody to hand off to, see Measure()
+  assert(pool.GetConcurrency() >= 2);
+  const auto timeout = std::chrono::milliseconds(AUTO_TUNE_HANDOFF_MILLIS);
+  std::vector<uint64_t> samples;
+  for (int round = 0; round < AUTO_TUNE_ROUNDS; round++) {
+    auto latency = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+    pool.Submit([&pool, &latency, timeout]() {
+      auto started = std::make_shared<std::atomic<bool>>(false);
+      auto spawned = Clock::now();
+      pool.Submit([started]() { started->store(true); });
+      while (!started->load() && Clock::now() - spawned < timeout) {
+        std::this_thread::yield();
+      }
+      if (started->load()) {
+        latency = NanosSince(spawned, Clock::now());
+      }
+    });
+    pool.WaitUntilFinished();
+    samples.push_back(latency);
+  }
+  return Median(samples);
+}
+
+auto MeasureWakeup(BasePool& pool) -> uint64_t {
+  std::vector<uint64_t> samples;
+  for (int round = 0; round < AUTO_TUNE_ROUNDS; round++) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(AUTO_TUNE_IDLE_MILLIS));
+    Clock::time_point started;
+    auto submitted = Clock::now();
+    pool.Submit([&started]() { started = Clock::now(); });
+    pool.WaitUntilFinished();
+    samples.push_back(NanosSince(submitted, started));
+  }
+  return Median(samples);
+}
+
+/* nanoseconds per element of a sequential sort, the leaf of a split */
+auto MeasureSortPerElement() -> double {
+  const size_t n = AUTO_TUNE_MIN_GRAIN * 16;
+  std::mt19937 random(AUTO_TUNE_VERSION);
+  std::vector<int> data(n);
+  double best = 1e9;
+  for (int round = 0; round < AUTO_TUNE_ROUNDS; round++) {
+    for (auto& value : data) {
+      value = static_cast<int>(random());
+    }
+    auto start = Clock::now();
+    std::sort(data.begin(), data.end());
+    best = std::min(best, static_cast<double>(NanosSince(start, Clock::now())) /
+                              static_cast<double>(n));
+  }
+  return std::max(best, 0.001);
+}
+
+/* all three measurements of a pool of kind with threads workers */
+auto Measure(PoolKind kind, int threads, const TuneResult& machine)
+    -> TuneResult {
+  auto pool = NewPool(kind, threads, PoolType::STREAM);
+  TuneResult candidate = machine;
+  candidate.pool = kind;
+  candidate.threads = threads;
+  candidate.spawn_ns = MeasureSpawn(*pool);
+  // left 0, not measured, on one worker, where nothing is ever handed off
+  if (threads >= 2) {
+    candidate.handoff_ns = MeasureHandoff(*pool);
+  }
+  candidate.wakeup_ns = MeasureWakeup(*pool);
+  pool->Drain();
+  return candidate;
+}
+
+}  // namespace
+
+auto AutoTuner::Tune(const std::string& path) -> TuneResult {
+  TuneResult result;
+  if (Load(path, result)) {
+    return result;
+  }
+  result = Calibrate();
+  Save(path, result);
+  return result;
+}
+
+auto AutoTuner::Calibrate() -> TuneResult {
+  TuneResult result;
+  int cpus = CpuCount();
+  ReadCaches(result);
+  result.machine = MachineOf(result, cpus);
+
+  // the pool first, with one worker per CPU
+  std::vector<TuneResult> candidates;
+  for (PoolKind kind : kPoolKinds) {
+    candidates.push_back(Measure(kind, cpus, result));
+  }
+  // on a single CPU the pools are compared on wake-up and spawns alone
+  bool handoff = cpus >= 2;
+  uint64_t best_handoff = UINT64_MAX;
+  uint64_t best_wakeup = UINT64_MAX;
+  for (auto& candidate : candidates) {
+    best_handoff = std::min(best_handoff, candidate.handoff_ns);
+    best_wakeup = std::min(best_wakeup, candidate.wakeup_ns);
+  }
+  bool chosen = false;
+  for (auto& candidate : candidates) {
+    if ((handoff && candidate.handoff_ns > best_handoff * AUTO_TUNE_SLACK) ||
+        candidate.wakeup_ns > best_wakeup * AUTO_TUNE_SLACK) {
+      continue;
+    }
+    if (!chosen || candidate.spawn_ns < result.spawn_ns) {
+      result = candidate;
+      chosen = true;
+    }
+  }
+  if (!chosen) {
+    // no pool is within the slack on both, go by the spawns alone
+    result = *std::min_element(
+        candidates.begin(), candidates.end(),
+        [](const TuneResult& a, const TuneResult& b) {
+          return a.spawn_ns < b.spawn_ns;
+        });
+  }
+
+  // then its thread count: fewer workers contend less, more may cover for
+  // the stalled ones; the cheapest spawn tree wins, on a tie the CPU count
+  for (int threads : {std::max(1, cpus / 2), cpus * 2}) {
+    if (threads == cpus) {
+      continue;
+    }
+    TuneResult candidate = Measure(result.pool, threads, result);
+    if (candidate.spawn_ns < result.spawn_ns) {
+      result = candidate;
+    }
+  }
+
+  // a leaf pays for its spawn and for being handed off, but its data
+  // should still fit the cache of the worker that sorts it
+  double target = static_cast<double>(AUTO_TUNE_AMORTIZE) *
+                  static_cast<double>(std::max<uint64_t>(
+                      result.spawn_ns, result.handoff_ns));
+  auto grain = static_cast<size_t>(target / MeasureSortPerElement());
+  size_t most = std::max<size_t>(
+      AUTO_TUNE_MIN_GRAIN, (result.l2_bytes > 0 ? result.l2_bytes
+                                                : result.llc_bytes) /
+                               sizeof(int));
+  result.grain = std::clamp<size_t>(grain, AUTO_TUNE_MIN_GRAIN, most);
+  return result;
+}
+
+auto AutoTuner::Load(const std::string& path, TuneResult& result) -> bool {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::map<std::string, std::string> values;
+  for (std::string line; std::getline(in, line);) {
+    std::istringstream fields(line);
+    std::string key, value;
+    if (line.empty() || line[0] == '#' || !(fields >> key >> value)) {
+      continue;
+    }
+    values[key] = value;
+  }
+  auto number = [&values](const char* key) -> uint64_t {
+    auto it = values.find(key);
+    return it == values.end() ? 0 : std::stoull(it->second);
+  };
+  TuneResult loaded;
+  try {
+    if (number("version") != AUTO_TUNE_VERSION) {
+      return false;
+    }
+    bool known = false;
+    for (PoolKind kind : kPoolKinds) {
+      if (values["pool"] == PoolName(kind)) {
+        loaded.pool = kind;
+        known = true;
+      }
+    }
+    loaded.threads = static_cast<int>(number("threads"));
+    loaded.grain = number("grain");
+    loaded.spawn_ns = number("spawn_ns");
+    loaded.handoff_ns = number("handoff_ns");
+    loaded.wakeup_ns = number("wakeup_ns");
+    loaded.l1d_bytes = number("l1d_bytes");
+    loaded.l2_bytes = number("l2_bytes");
+    loaded.llc_bytes = number("llc_bytes");
+    loaded.machine = number("machine");
+    if (!known || loaded.threads < 1 || loaded.grain < 1) {
+      return false;
+    }
+  } catch (const std::exception&) {
+    // not a number, somebody edited it
+    return false;
+  }
+  // the CPUs and the caches as they are now
+  TuneResult now;
+  ReadCaches(now);
+  if (loaded.machine != MachineOf(now, CpuCount())) {
+    return false;
+  }
+  loaded.loaded = true;
+  result = loaded;
+  return true;
+}
+
+auto AutoTuner::Save(const std::string& path, const TuneResult& result)
+    -> bool {
+  std::ofstream out(path, std::ios::trunc);
+  out << "# zorro auto-tune, delete the file to tune again\n"
+      << "version " << AUTO_TUNE_VERSION << "\n"
+      << "machine " << result.machine << "\n"
+      << "pool " << PoolName(result.pool) << "\n"
+      << "threads " << result.threads << "\n"
+      << "grain " << result.grain << "\n"
+      << "spawn_ns " << result.spawn_ns << "\n"
+      << "handoff_ns " << result.handoff_ns << "\n"
+      << "wakeup_ns " << result.wakeup_ns << "\n"
+      << "l1d_bytes " << result.l1d_bytes << "\n"
+      << "l2_bytes " << result.l2_bytes << "\n"
+      << "llc_bytes " << result.llc_bytes << "\n";
+  out.close();
+  return !out.fail();
+}
+
+auto AutoTuner::MakePool(const TuneResult& result, PoolType pool_type)
+    -> std::unique_ptr<BasePool> {
+  auto pool = NewPool(result.pool, result.threads, pool_type);
+  pool->SetGrain(result.grain);
+  return pool;
+}
+
+auto AutoTuner::PoolName(PoolKind kind) -> const char* {
+  switch (kind) {
+    case PoolKind::GLOBAL:
+      return "global";
+    case PoolKind::LOCAL_COARSE:
+      return "local_coarse";
+    case PoolKind::LOCAL_FINE:
+      return "local_fine";
+    case PoolKind::LOG_STEAL:
+      return "log_steal";
+    case PoolKind::NAIVE_STEAL:
+      return "naive_steal";
+    case PoolKind::NAIVE_STEAL_LIFO:
+      return "naive_steal_lifo";
+  }
+  return "unknown";
+}
+
+void AutoTuner::Print(std::ostream& out, const TuneResult& result) {
+  out << "Tuned: pool " << PoolName(result.pool) << ", " << result.threads
+      << " threads, grain " << result.grain << " elements"
+      << (result.loaded ? " (kept from before)" : " (calibrated)")
+      << std::endl;
+  out << "Tuned from: spawn " << result.spawn_ns << " ns, hand-off ";
+  if (result.threads >= 2) {
+    out << result.handoff_ns << " ns";
+  } else {
+    out << "not measured (one thread)";
+  }
+  out << ", wake-up " << result.wakeup_ns
+      << " ns, L1d " << (result.l1d_bytes >> 10) << " KiB, L2 "
+      << (result.l2_bytes >> 10) << " KiB, LLC " << (result.llc_bytes >> 10)
+      << " KiB" << std::endl;
+}
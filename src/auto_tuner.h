@@ -0,0 +1,105 @@
+/**
+ * @file auto_tuner.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the startup auto-tuner: instead of
+ * picking a pool, a thread count and a sequential cutoff by hand for every
+ * machine, it measures the spawn cost, the hand-off cost to another worker
+ * and the wake-up latency of each pool, reads the cache sizes from /sys,
+ * chooses from those, and keeps the choice in a file, so that only the
+ * first start on a machine pays for the calibration; the thread count is
+ * swept around the CPU count with the chosen pool
+ *
+ * the file is plain text, one "key value" per line; it is ignored once the
+ * machine it was tuned on differs, and deleting it tunes again
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "base_pool.h"
+
+/* where the tuning is kept, relative to the working directory */
+#define AUTO_TUNE_FILE ".zorro_tune"
+#define AUTO_TUNE_VERSION 2
+/* levels of the spawn tree measured, 2^(depth - 1) tasks are submitted */
+#define AUTO_TUNE_TREE_DEPTH 14
+/* rounds of every measurement, the best or the median is taken */
+#define AUTO_TUNE_ROUNDS 5
+/* idle time before a wake-up is measured, long enough for workers to park */
+#define AUTO_TUNE_IDLE_MILLIS 5
+/* the longest a spawned task is waited for to be taken by another worker */
+#define AUTO_TUNE_HANDOFF_MILLIS 20
+/* a pool that hands off or wakes up slower than this many times the best
+ * pool is passed over */
+#define AUTO_TUNE_SLACK 4
+/* a leaf task should run this many times as long as spawning it costs */
+#define AUTO_TUNE_AMORTIZE 100
+#define AUTO_TUNE_MIN_GRAIN 1024
+
+/* the pools the tuner chooses from */
+enum class PoolKind {
+  GLOBAL,
+  LOCAL_COARSE,
+  LOCAL_FINE,
+  LOG_STEAL,
+  NAIVE_STEAL,
+  NAIVE_STEAL_LIFO
+};
+
+struct TuneResult {
+  /* the choice */
+  PoolKind pool = PoolKind::NAIVE_STEAL;
+  int threads = 1;
+  /* elements of int a recursive split stops at and sorts sequentially,
+   * MakePool() sets it as the pool's grain, see BasePool::SetGrain() */
+  size_t grain = AUTO_TUNE_MIN_GRAIN;
+
+  /* what it was made from, all of the chosen pool and thread count;
+   * handoff_ns stays 0 with one thread, which has nobody to hand off to */
+  uint64_t spawn_ns = 0;
+  uint64_t handoff_ns = 0;
+  uint64_t wakeup_ns = 0;
+  size_t l1d_bytes = 0;
+  size_t l2_bytes = 0;
+  size_t llc_bytes = 0;
+
+  /* identifies the CPUs and caches it was tuned on */
+  uint64_t machine = 0;
+  /* whether it came from the file rather than a calibration, not saved */
+  bool loaded = false;
+};
+
+class AutoTuner {
+ public:
+  /**
+   * The tuning kept in path if it was made on this machine, or else a
+   * fresh calibration, which is saved to path for the next start
+   */
+  static auto Tune(const std::string& path = AUTO_TUNE_FILE) -> TuneResult;
+
+  /* measure every pool and thread count and choose, takes a few seconds */
+  static auto Calibrate() -> TuneResult;
+
+  /* @return false when there is no such file, or it is for another machine */
+  static auto Load(const std::string& path, TuneResult& result) -> bool;
+
+  /* @return whether the whole file was written */
+  static auto Save(const std::string& path, const TuneResult& result) -> bool;
+
+  /* a new pool of the chosen kind, thread count and grain */
+  static auto MakePool(const TuneResult& result, PoolType pool_type)
+      -> std::unique_ptr<BasePool>;
+
+  static auto PoolName(PoolKind kind) -> const char*;
+
+  /* one line with the choice, one with what it was made from */
+  static void Print(std::ostream& out, const TuneResult& result);
+};
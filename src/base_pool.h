@@ -9,8 +9,21 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "cancellation_token.h"
 
 /**
  * Since Template and virtual keyword do not work well together
@@ -22,6 +35,9 @@
  */
 using Task = std::function<void(void)>;
 
+/* receives the exception of a failed task, see BasePool::SetErrorHandler() */
+using ErrorHandler = std::function<void(std::exception_ptr)>;
+
 /*
  * The Pool Type
  * STEAM means the worker will start working on tasks as soon as submission
@@ -37,52 +53,309 @@ enum class PoolType { STREAM, BATCH };
  * PREPARE is in the BATCH mode when pool is not set to start running
  * RUNNING is when pool workers are actively working
  * EXIT means no more tasks will be submitted and worker could exit thread loop
+ * SHUTDOWN means workers leave right away, tasks still queued are abandoned
+ *
+ * The status only ever moves forward in the above order
  */
-enum class PoolStatus { PREPARE, RUNNING, EXIT };
+enum class PoolStatus { PREPARE, RUNNING, EXIT, SHUTDOWN };
+
+/*
+ * The bookkeeping every pool shares, whatever interface it puts on top:
+ * the status machine, the task counters, the error path and the binding of
+ * worker threads; BasePool builds its virtual interface on it, the policy
+ * Pool<> of policy_pool.h its inlined one, so the two cannot drift apart
+ *
+ * Tag gives every pool class its own worker binding: the threads of a
+ * PoolAdapter are workers of the adapter and of the Pool<> inside it
+ */
+template <typename Tag>
+class PoolCore {
+ public:
+  /*
+   * Get the thread count
+   */
+  auto GetConcurrency() -> int { return concurrency_; }
+
+  /*
+   * Get the PoolStatus
+   * acquire pairs with the release in SetStatus(), whatever was written
+   * before a status change is visible to whoever sees the new status
+   */
+  auto GetStatus() -> PoolStatus {
+    return status_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Install the handler for exceptions escaping a task
+   * it runs on the thread of the failed task, which then carries on with
+   * the next one; without a handler the exception is printed to stderr
+   * tasks from Async() and TaskGroup deliver their exceptions there instead
+   */
+  void SetErrorHandler(ErrorHandler handler) {
+    std::unique_lock<std::mutex> lock(error_mtx_);
+    error_handler_ = std::move(handler);
+  }
+
+  /*
+   * Get how many tasks have ended with an exception so far
+   */
+  auto GetFailedCount() -> uint64_t {
+    return failed_count_.load(std::memory_order_relaxed);
+  }
+
+  /*
+   * Get how many tasks have been dropped without running so far
+   * either through a cancelled token, or abandoned by a Shutdown(); the
+   * abandoned ones are counted as the workers leave, see Join()
+   */
+  auto GetCancelledCount() -> uint64_t {
+    return cancelled_count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Run a task the way the workers do: an exception is counted and handed
+   * to the error handler instead of unwinding the worker
+   * the try block costs nothing unless the task actually throws
+   */
+  template <typename F>
+  void RunTask(F&& task) {
+    if (std::exception_ptr error = RunCapturing(std::forward<F>(task))) {
+      ReportError(error);
+    }
+  }
+
+  /**
+   * Run func, for wrappers that deliver the exception somewhere else
+   * @return the exception it has thrown, counted as a failed task, or null
+   */
+  template <typename F>
+  auto RunCapturing(F&& func) -> std::exception_ptr;
 
-class BasePool {
+  /* hand an exception to the error handler, see SetErrorHandler() */
+  void ReportError(std::exception_ptr error);
+
+  /*
+   * Get the worker index of the calling thread in this pool
+   * returns -1 if the caller is not one of this pool's workers
+   */
+  auto CurrentWorkerId() -> int {
+    return tls_current_pool_ == this ? tls_worker_id_ : -1;
+  }
+
+ protected:
+  PoolCore(int concurrency, PoolStatus status)
+      : concurrency_(concurrency), status_(status) {}
+
+  /* a pool is deleted as itself or as a BasePool, never as a PoolCore */
+  ~PoolCore() = default;
+
+  PoolCore(const PoolCore&) = delete;
+  PoolCore& operator=(const PoolCore&) = delete;
+
+  /* record on a worker thread which pool and slot it serves */
+  void BindWorker(int worker_id) {
+    tls_current_pool_ = this;
+    tls_worker_id_ = worker_id;
+  }
+
+  /**
+   * Park the calling worker until the status leaves PREPARE
+   * in BATCH mode the pool sits pre-warmed here without using any CPU
+   */
+  void WaitForBegin() {
+    if (GetStatus() != PoolStatus::PREPARE) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(status_mtx_);
+    status_cv_.wait(
+        lock, [this]() -> bool { return GetStatus() != PoolStatus::PREPARE; });
+  }
+
+  /* move the status forward, never backward, and release the start barrier */
+  void SetStatus(PoolStatus status) {
+    {
+      std::unique_lock<std::mutex> lock(status_mtx_);
+      // status_mtx_ serializes the writers, readers only need the release
+      if (status_.load(std::memory_order_relaxed) < status) {
+        status_.store(status, std::memory_order_release);
+      }
+    }
+    status_cv_.notify_all();
+  }
+
+  /*
+   * Task counters, shared by all pools
+   *
+   * A submission is counted relaxed: the queue hand-off (a mutex or a
+   * release/acquire pair) already orders it before the run of its task.
+   * A finish is counted acq_rel: the release publishes the effects of the
+   * task to WaitUntilFinished(), the acquire chains the finishes together
+   * so that the last finisher sees every submission of the tasks finished
+   * before it, and cannot miss that it is the last one.
+   */
+
+  /* count a submission, @return how many came before it */
+  auto CountSubmit() -> uint64_t {
+    return submit_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* count a finished task, @return whether no submitted task is left */
+  auto CountFinish() -> bool {
+    uint64_t finished = finish_count_.fetch_add(1, std::memory_order_acq_rel);
+    return finished + 1 == submit_count_.load(std::memory_order_relaxed);
+  }
+
+  /* whether every task submitted so far has finished */
+  auto AllFinished() -> bool {
+    // finish first: its acquire makes the matching submissions visible
+    uint64_t finished = finish_count_.load(std::memory_order_acquire);
+    return finished == submit_count_.load(std::memory_order_relaxed);
+  }
+
+  int concurrency_;
+  std::atomic<PoolStatus> status_;
+  /* submitters and finishers hit different lines */
+  alignas(64) std::atomic<uint64_t> submit_count_{0};
+  alignas(64) std::atomic<uint64_t> finish_count_{0};
+  std::atomic<uint64_t> failed_count_{0};
+  std::atomic<uint64_t> cancelled_count_{0};
+
+ private:
+  std::mutex status_mtx_;
+  std::condition_variable status_cv_;
+
+  std::mutex error_mtx_;
+  ErrorHandler error_handler_;  // guarded by error_mtx_
+
+  inline static thread_local const PoolCore* tls_current_pool_ = nullptr;
+  inline static thread_local int tls_worker_id_ = -1;
+};
+
+class BasePool : public PoolCore<BasePool> {
  public:
   /* requires the thread count and type specification */
   BasePool(int concurrency, PoolType pool_type)
-      : concurrency_(concurrency),
-        type_(pool_type),
-        status_(pool_type == PoolType::BATCH ? PoolStatus::PREPARE
-                                             : PoolStatus::RUNNING){};
+      : PoolCore(concurrency, pool_type == PoolType::BATCH
+                                  ? PoolStatus::PREPARE
+                                  : PoolStatus::RUNNING),
+        type_(pool_type){};
 
   /* virtual dtor as always */
   virtual ~BasePool(){};
 
-  /*
-   * Get the thread count
-   */
-  auto GetConcurrency() -> int { return concurrency_; }
-
   /*
    * Get the PoolType
    */
   auto GetType() -> PoolType { return type_; }
 
-  /*
-   * Get the PoolStatus
+  /**
+   * Set the length below which ParallelSort, the parallel primitives and
+   * the recursive benchmarks stop cutting their work into tasks, e.g. to
+   * the one AutoTuner found; 0 leaves each at its compile-time default
    */
-  auto GetStatus() -> PoolStatus { return status_; }
+  void SetGrain(size_t grain) {
+    grain_.store(grain, std::memory_order_relaxed);
+  }
+
+  /* the grain set with SetGrain(), fallback while none is */
+  auto GetGrain(size_t fallback) -> size_t {
+    size_t grain = grain_.load(std::memory_order_relaxed);
+    return grain > 0 ? grain : fallback;
+  }
 
   /**
    * Tell worker threads to begin working
    * i.e. set the status to RUNNING
-   * Usually used in the BATCH mode
+   * Usually used in the BATCH mode, workers parked in WaitForBegin() wake up
    */
   void Begin() {
-    assert(status_ != PoolStatus::EXIT);
-    status_ = PoolStatus::RUNNING;
+    assert(GetStatus() == PoolStatus::PREPARE ||
+           GetStatus() == PoolStatus::RUNNING);
+    SetStatus(PoolStatus::RUNNING);
   }
 
   /**
    * Signal to worker threads that no more tasks will be submitted
    * i.e. set the status to EXIT
-   * They can clean up and return from the thread loop
+   * They finish the queued tasks, clean up and return from the thread loop
+   */
+  void Exit() {
+    SetStatus(PoolStatus::EXIT);
+    WakeWorkers();
+  }
+
+  /**
+   * Graceful stop: wait until every submitted task has finished, then Exit()
+   */
+  void Drain() {
+    WaitUntilFinished();
+    Exit();
+  }
+
+  /**
+   * Immediate stop: workers return as soon as their current task is done
+   * tasks still queued are never run, WaitUntilFinished() stops waiting
+   */
+  void Shutdown() {
+    SetStatus(PoolStatus::SHUTDOWN);
+    WakeWorkers();
+  }
+
+  /**
+   * Exit(), unless shut down already, and wait for the workers to leave
+   * the tasks a Shutdown() abandoned are in GetCancelledCount() by then;
+   * the destructor does the same, call it first only to look at the counts
+   */
+  void Join() {
+    Exit();
+    JoinWorkers();
+  }
+
+  /**
+   * Run task unless token has been cancelled, which is counted instead
+   * for wrappers that must do their own bookkeeping either way, see TaskGroup
+   * @return whether the task has run
+   */
+  auto RunUnlessCancelled(const Task& task, const CancellationToken& token)
+      -> bool {
+    if (token.IsCancelled()) {
+      cancelled_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    task();
+    return true;
+  }
+
+  /**
+   * Submit a function and get its result, or its exception, from a future
+   * func has to be copyable, as every Task is
+   */
+  template <typename F>
+  auto Async(F&& func) -> std::future<decltype(func())>;
+
+  /**
+   * Run a function that is about to block, e.g. a sleep or blocking syscall
+   * pools able to compensate start or wake a spare worker meanwhile
+   * @param func the blocking function, its return value is passed through
+   */
+  template <typename F>
+  auto Blocking(F&& func) -> decltype(func());
+
+  /**
+   * Spawn several children of the current task at once
+   * all but the last child are submitted for other workers to pick up,
+   * the last one runs inline on the calling thread, which saves a round
+   * trip through the queue and keeps its data in the caller's cache
+   */
+  template <typename F, typename... Rest>
+  void Spawn(F&& first, Rest&&... rest);
+
+  /**
+   * Hooks around a blocking region, see BlockingRegion below
+   * by default the pool does not compensate for a blocked worker
    */
-  void Exit() { status_ = PoolStatus::EXIT; }
+  virtual void EnterBlocking() {}
+  virtual void LeaveBlocking() {}
 
   /* --- virtual interface to be implemented --- */
   /**
@@ -93,9 +366,38 @@ class BasePool {
    */
   virtual void Submit(Task task) = 0;
 
+  /**
+   * Submit a Task with an affinity key
+   * tasks with the same key are routed to the same worker queue by hash,
+   * so that related tasks share that worker's cache
+   * @param ordered if true, tasks of one key additionally run one at a time
+   * in submission order (strand semantics) and are never stolen
+   * pools without per-worker queues ignore the key and cannot order, they
+   * assert ordered is false; post to a Strand on those instead
+   */
+  virtual void Submit([[maybe_unused]] uint64_t key, Task task,
+                      [[maybe_unused]] bool ordered = false) {
+    assert(!ordered);
+    Submit(std::move(task));
+  }
+
+  /**
+   * Submit a Task that is abandoned once token is cancelled
+   * the token is checked when a worker picks the task up: a cancelled task
+   * is dropped without running, counts as finished for WaitUntilFinished()
+   * and is added to GetCancelledCount()
+   */
+  void Submit(Task task, CancellationToken token) {
+    Submit([this, task = std::move(task), token = std::move(token)]() {
+      RunUnlessCancelled(task, token);
+    });
+  }
+
   /**
    * Block waiting until all the tasks submitted so far has all finished
    * Typically, should call Exit() first and then WaitUntilFinished()
+   * The task counters are never reset, so it can be called repeatedly,
+   * each call ends one epoch of submissions
    */
   virtual void WaitUntilFinished() = 0;
   /* --- end of virtual interface --- */
@@ -107,7 +409,125 @@ class BasePool {
   BasePool& operator=(const BasePool&) = delete;
   BasePool& operator=(BasePool&&) = delete;
 
-  int concurrency_;
+  /* spread affinity keys over the workers, sequential keys included */
+  auto KeyToWorker(uint64_t key) -> int {
+    // splitmix64 finalizer
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    key = key ^ (key >> 31);
+    return static_cast<int>(key % static_cast<uint64_t>(concurrency_));
+  }
+
+  /**
+   * Wake up workers sleeping on their queues so they observe a status change
+   * also wake the WaitUntilFinished() caller, which stops waiting on SHUTDOWN
+   */
+  virtual void WakeWorkers() {}
+
+  /**
+   * Wait for every worker to return, then drop the tasks still queued and
+   * add them to cancelled_count_; called again by the destructor, so a
+   * second call must find nothing left to do
+   */
+  virtual void JoinWorkers() {}
+
   PoolType type_;
-  PoolStatus status_;
+  std::atomic<size_t> grain_{0};
+};
+
+/*
+ * RAII marker that the current task is blocked for the scope's lifetime
+ * i.e. { BlockingRegion region(pool); read(fd, buf, len); }
+ */
+class BlockingRegion {
+ public:
+  explicit BlockingRegion(BasePool& pool) : pool_(pool) {
+    pool_.EnterBlocking();
+  }
+
+  ~BlockingRegion() { pool_.LeaveBlocking(); }
+
+  BlockingRegion(const BlockingRegion&) = delete;
+  BlockingRegion& operator=(const BlockingRegion&) = delete;
+
+ private:
+  BasePool& pool_;
 };
+
+template <typename F>
+auto BasePool::Blocking(F&& func) -> decltype(func()) {
+  BlockingRegion region(*this);
+  return std::forward<F>(func)();
+}
+
+template <typename F, typename... Rest>
+void BasePool::Spawn(F&& first, Rest&&... rest) {
+  if constexpr (sizeof...(rest) == 0) {
+    std::forward<F>(first)();
+  } else {
+    Submit(Task(std::forward<F>(first)));
+    Spawn(std::forward<Rest>(rest)...);
+  }
+}
+
+template <typename Tag>
+template <typename F>
+auto PoolCore<Tag>::RunCapturing(F&& func) -> std::exception_ptr {
+  try {
+    std::forward<F>(func)();
+  } catch (...) {
+    failed_count_.fetch_add(1, std::memory_order_relaxed);
+    return std::current_exception();
+  }
+  return nullptr;
+}
+
+template <typename Tag>
+void PoolCore<Tag>::ReportError(std::exception_ptr error) {
+  ErrorHandler handler;
+  {
+    std::unique_lock<std::mutex> lock(error_mtx_);
+    handler = error_handler_;
+  }
+  if (handler) {
+    // a throwing handler would unwind the worker after all; the task is
+    // counted as failed already, the handler's own error is only printed
+    try {
+      handler(error);
+    } catch (const std::exception& e) {
+      fprintf(stderr, "error handler failed: %s\n", e.what());
+    } catch (...) {
+      fprintf(stderr, "error handler failed: unknown exception\n");
+    }
+    return;
+  }
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::exception& e) {
+    fprintf(stderr, "task failed: %s\n", e.what());
+  } catch (...) {
+    fprintf(stderr, "task failed: unknown exception\n");
+  }
+}
+
+template <typename F>
+auto BasePool::Async(F&& func) -> std::future<decltype(func())> {
+  using R = decltype(func());
+  // shared, because a Task has to be copyable and a promise is not
+  auto promise = std::make_shared<std::promise<R>>();
+  std::future<R> future = promise->get_future();
+  Submit([this, promise, func = std::forward<F>(func)]() mutable {
+    std::exception_ptr error = RunCapturing([&promise, &func]() {
+      if constexpr (std::is_void_v<R>) {
+        func();
+        promise->set_value();
+      } else {
+        promise->set_value(func());
+      }
+    });
+    if (error) {
+      promise->set_exception(error);
+    }
+  });
+  return future;
+}
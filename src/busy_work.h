@@ -0,0 +1,52 @@
+/**
+ * @file busy_work.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements calibrated busy work: a dependent
+ * chain of multiplies the compiler cannot fold away, and its rate on this
+ * machine, so synthetic tasks can keep a worker busy for a given time
+ * without sleeping, as the real tasks they stand in for would
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/* the end of every spin, stored so the loop is not optimized out */
+inline std::atomic<uint64_t> busy_spin_sink{0};
+
+inline void BusySpin(uint64_t iterations) {
+  uint64_t state = iterations;
+  for (uint64_t i = 0; i < iterations; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  busy_spin_sink.store(state, std::memory_order_relaxed);
+}
+
+/* spin iterations per microsecond of this machine, measured once */
+inline auto BusySpinRate() -> uint64_t {
+  static const uint64_t rate = []() {
+    const uint64_t iterations = 1 << 22;
+    double best = 0;
+    // the fastest of a few rounds, the others were preempted
+    for (int round = 0; round < 5; round++) {
+      auto start = std::chrono::steady_clock::now();
+      BusySpin(iterations);
+      std::chrono::duration<double, std::micro> took =
+          std::chrono::steady_clock::now() - start;
+      best = std::max(best, iterations / took.count());
+    }
+    return std::max<uint64_t>(1, static_cast<uint64_t>(best));
+  }();
+  return rate;
+}
+
+/* keep the calling thread busy for about nanos nanoseconds of CPU */
+inline void BusyWork(uint64_t nanos) {
+  BusySpin(BusySpinRate() * nanos / 1000);
+}
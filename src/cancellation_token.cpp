@@ -0,0 +1,60 @@
+/**
+ * @file cancellation_token.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the CancellationToken
+ */
+
+#include "cancellation_token.h"
+
+#include <utility>
+
+CancellationToken::CancellationToken() : state_(std::make_shared<State>()) {}
+
+void CancellationToken::Cancel() const {
+  // walk the tree with an explicit stack, chains of children can be long
+  std::vector<std::shared_ptr<State>> pending{state_};
+  while (!pending.empty()) {
+    std::shared_ptr<State> state = std::move(pending.back());
+    pending.pop_back();
+    std::vector<std::weak_ptr<State>> children;
+    {
+      // set under the mutex so that CreateChild() either sees the flag
+      // or has its child registered before the children are taken
+      std::unique_lock<std::mutex> lock(state->mtx);
+      if (state->cancelled.exchange(true, std::memory_order_acq_rel)) {
+        continue;
+      }
+      children.swap(state->children);
+    }
+    for (auto& child : children) {
+      if (auto alive = child.lock()) {
+        pending.push_back(std::move(alive));
+      }
+    }
+  }
+}
+
+auto CancellationToken::CreateChild() const -> CancellationToken {
+  CancellationToken child;
+  std::unique_lock<std::mutex> lock(state_->mtx);
+  if (state_->cancelled.load(std::memory_order_relaxed)) {
+    child.state_->cancelled.store(true, std::memory_order_release);
+    return child;
+  }
+  auto& children = state_->children;
+  if (children.size() == children.capacity()) {
+    // drop the children that are gone before the vector grows
+    std::vector<std::weak_ptr<State>> alive;
+    for (auto& existing : children) {
+      if (!existing.expired()) {
+        alive.push_back(std::move(existing));
+      }
+    }
+    children.swap(alive);
+  }
+  children.push_back(child.state_);
+  return child;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file cancellation_token.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the CancellationToken
+ * through which queued tasks are abandoned cooperatively
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * A shared flag that can only go from live to cancelled
+ * copies of a token refer to the same flag, so a token can be handed to
+ * every task of a request and cancelled once from anywhere
+ *
+ * Child tokens are cancelled along with their parent, but can also be
+ * cancelled on their own without touching the parent or their siblings
+ */
+class CancellationToken {
+ public:
+  /* a fresh token, not cancelled */
+  CancellationToken();
+
+  /* cancel this token and all its descendants, idempotent */
+  void Cancel() const;
+
+  auto IsCancelled() const -> bool {
+    return state_->cancelled.load(std::memory_order_acquire);
+  }
+
+  /* a new token that is cancelled whenever this one is */
+  auto CreateChild() const -> CancellationToken;
+
+ private:
+  struct State {
+    std::atomic<bool> cancelled{false};
+    std::mutex mtx;
+    /* weak so that a child nobody holds any more can go away */
+    std::vector<std::weak_ptr<State>> children;  // guarded by mtx
+  };
+
+  std::shared_ptr<State> state_;
+};
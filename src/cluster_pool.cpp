@@ -0,0 +1,528 @@
+/**
+ * @file cluster_pool.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the ClusterPool
+ *
+ * a message is a 4-byte length, CLUSTER_MAX_FRAME at most, and that many
+ * bytes of wire format, its first varint the type:
+ *   REQUEST  want, done, failed   thief to victim, asks for up to want
+ *                                 tasks and reports done of the victim's
+ *                                 tasks finished since, failed of them thrown
+ *   TASKS    count, count times   victim to thief, the answer to a REQUEST,
+ *            (function id, args)  possibly empty
+ * every REQUEST gets exactly one TASKS, in order, so a thief keeps up to
+ * CLUSTER_PIPELINE_DEPTH of them outstanding without tagging them
+ *
+ * the tasks a thief runs are never stolen again, so their counts always go
+ * back over the connection they came on, to the node waiting for them
+ */
+
+#include "cluster_pool.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "wire_format.h"
+
+namespace {
+
+enum MessageType : uint64_t { REQUEST = 1, TASKS = 2 };
+
+auto WriteAll(int fd, const char* data, size_t size) -> bool {
+  while (size > 0) {
+    ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+
+auto ReadAll(int fd, char* data, size_t size) -> bool {
+  while (size > 0) {
+    ssize_t got = recv(fd, data, size, 0);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    data += got;
+    size -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+auto SendMessage(int fd, const std::string& payload) -> bool {
+  auto length = static_cast<uint32_t>(payload.size());
+  // one send, small messages are not split over two segments
+  std::string frame(reinterpret_cast<const char*>(&length), sizeof(length));
+  frame += payload;
+  return WriteAll(fd, frame.data(), frame.size());
+}
+
+auto ReadMessage(int fd, std::string& payload) -> bool {
+  uint32_t length;
+  if (!ReadAll(fd, reinterpret_cast<char*>(&length), sizeof(length)) ||
+      length > CLUSTER_MAX_FRAME) {
+    return false;
+  }
+  payload.resize(length);
+  return ReadAll(fd, payload.data(), length);
+}
+
+/* @return the connected socket, -1 if the peer cannot be reached now */
+auto Connect(const std::string& address) -> int {
+  size_t colon = address.rfind(':');
+  if (colon == std::string::npos) {
+    throw std::invalid_argument("peer is not host:port: " + address);
+  }
+  std::string host = address.substr(0, colon);
+  std::string port = address.substr(colon + 1);
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) {
+    return -1;
+  }
+  int fd = -1;
+  for (addrinfo* at = found; at != nullptr && fd < 0; at = at->ai_next) {
+    fd = socket(at->ai_family, at->ai_socktype | SOCK_CLOEXEC,
+                at->ai_protocol);
+    if (fd >= 0 && connect(fd, at->ai_addr, at->ai_addrlen) != 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(found);
+  return fd;
+}
+
+/* run a registered task, throws when nothing is registered under its ID */
+void Call(const WireTask& task) {
+  RemoteFunction function = TaskRegistry::Find(task.function_id);
+  if (function == nullptr) {
+    throw std::runtime_error("no task registered under its ID");
+  }
+  function(task.args.data(), task.args.size());
+}
+
+void NoDelay(int fd) {
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+}  // namespace
+
+struct ClusterPool::Peer {
+  explicit Peer(std::string peer_address) : address(std::move(peer_address)) {}
+
+  std::string address;
+  std::atomic<int> fd{-1};
+  /* of the tasks stolen from this peer: finished, and thrown of those */
+  std::atomic<uint64_t> done{0};
+  std::atomic<uint64_t> failed{0};
+  /* how much of the above the peer has been told, stealer thread only */
+  uint64_t reported_done = 0;
+  uint64_t reported_failed = 0;
+  /* stolen from this peer and not finished yet */
+  std::atomic<int64_t> outstanding{0};
+  std::thread stealer;
+};
+
+ClusterPool::ClusterPool(int concurrency, uint16_t port,
+                         std::vector<std::string> peers,
+                         const std::string& bind_address)
+    : BasePool(concurrency, PoolType::STREAM),
+      local_(concurrency, PoolType::STREAM) {
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) {
+    throw std::invalid_argument("not an IPv4 address: " + bind_address);
+  }
+  listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  int on = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  socklen_t length = sizeof(address);
+  if (listen_fd_ < 0 ||
+      bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), length) != 0 ||
+      listen(listen_fd_, SOMAXCONN) != 0 ||
+      getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+                  &length) != 0) {
+    int error = errno;
+    if (listen_fd_ >= 0) {
+      close(listen_fd_);
+    }
+    // local_ is up already, its dtor takes its workers down
+    throw std::system_error(error, std::generic_category(), "listen");
+  }
+  port_ = ntohs(address.sin_port);
+  listener_ = std::thread([this]() { Listen(); });
+  for (auto& peer : peers) {
+    peers_.push_back(std::make_unique<Peer>(std::move(peer)));
+  }
+  for (auto& peer : peers_) {
+    Peer* stealing = peer.get();
+    peer->stealer = std::thread([this, stealing]() { Steal(*stealing); });
+  }
+}
+
+ClusterPool::~ClusterPool() {
+  Exit();
+  // the stealers leave once the counts of what they took have gone back
+  for (auto& peer : peers_) {
+    peer->stealer.join();
+  }
+  shutdown(listen_fd_, SHUT_RDWR);
+  listener_.join();
+  close(listen_fd_);
+  {
+    std::unique_lock<std::mutex> lock(serve_mtx_);
+    for (int fd : serve_fds_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+  }
+  for (auto& server : servers_) {
+    server.join();
+  }
+  for (int fd : serve_fds_) {
+    close(fd);
+  }
+  // local_ goes next, and runs whatever is still queued
+}
+
+void ClusterPool::Submit(Task task) {
+  assert(GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  local_queued_.fetch_add(1, std::memory_order_relaxed);
+  local_.Submit([this, task = std::move(task)]() {
+    local_queued_.fetch_sub(1, std::memory_order_relaxed);
+    RunTask(task);
+    Finish(1);
+  });
+}
+
+void ClusterPool::Submit(uint64_t key, Task task, bool ordered) {
+  assert(GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  local_queued_.fetch_add(1, std::memory_order_relaxed);
+  local_.Submit(
+      key,
+      [this, task = std::move(task)]() {
+        local_queued_.fetch_sub(1, std::memory_order_relaxed);
+        RunTask(task);
+        Finish(1);
+      },
+      ordered);
+}
+
+void ClusterPool::Submit(uint32_t function_id, std::string args) {
+  assert(GetStatus() == PoolStatus::RUNNING);
+  if (args.size() > CLUSTER_MAX_EXPORT_ARGS) {
+    Submit([task = WireTask{function_id, std::move(args)}]() { Call(task); });
+    return;
+  }
+  CountSubmit();
+  {
+    std::unique_lock<std::mutex> lock(exported_mtx_);
+    exported_.push_back(WireTask{function_id, std::move(args)});
+  }
+  // one runner per task, it finds nothing when a thief took one meanwhile
+  local_queued_.fetch_add(1, std::memory_order_relaxed);
+  local_.Submit([this]() { RunExported(); });
+}
+
+void ClusterPool::RunExported() {
+  local_queued_.fetch_sub(1, std::memory_order_relaxed);
+  WireTask task;
+  {
+    std::unique_lock<std::mutex> lock(exported_mtx_);
+    if (exported_.empty()) {
+      return;
+    }
+    task = std::move(exported_.back());
+    exported_.pop_back();
+  }
+  RunTask([&task]() { Call(task); });
+  Finish(1);
+}
+
+void ClusterPool::Finish(uint64_t count) {
+  // CountFinish() for count tasks at once
+  uint64_t finished =
+      finish_count_.fetch_add(count, std::memory_order_acq_rel) + count;
+  if (finished == submit_count_.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(mtx_count_);
+    cv_count_.notify_all();
+  }
+}
+
+void ClusterPool::WaitUntilFinished() {
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
+}
+
+void ClusterPool::WakeWorkers() {
+  if (GetStatus() == PoolStatus::SHUTDOWN) {
+    local_.Shutdown();
+    // no counts go back any more, unblock the stealers right away
+    for (auto& peer : peers_) {
+      int fd = peer->fd.load(std::memory_order_acquire);
+      if (fd >= 0) {
+        shutdown(fd, SHUT_RDWR);
+      }
+    }
+  }
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
+}
+
+auto ClusterPool::Hungry() -> bool {
+  if (GetStatus() != PoolStatus::RUNNING ||
+      stolen_outstanding_.load(std::memory_order_relaxed) >=
+          CLUSTER_STEAL_BATCH) {
+    return false;
+  }
+  // a worker is about to run dry once fewer closures wait than there are
+  // workers, ask now so that the batch arrives before it does
+  if (local_queued_.load(std::memory_order_relaxed) >= concurrency_) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(exported_mtx_);
+  return exported_.empty();
+}
+
+void ClusterPool::Listen() {
+  for (;;) {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      // shut down by the dtor
+      return;
+    }
+    NoDelay(fd);
+    std::unique_lock<std::mutex> lock(serve_mtx_);
+    serve_fds_.push_back(fd);
+    servers_.emplace_back([this, fd]() { Serve(fd); });
+  }
+}
+
+void ClusterPool::Serve(int fd) {
+  std::string message;
+  while (ReadMessage(fd, message)) {
+    uint64_t want;
+    try {
+      WireReader reader(message);
+      if (reader.GetVarint() != REQUEST) {
+        break;
+      }
+      want = reader.GetVarint();
+      uint64_t done = reader.GetVarint();
+      uint64_t failed = reader.GetVarint();
+      if (done > 0) {
+        remote_count_.fetch_add(done, std::memory_order_relaxed);
+        failed_count_.fetch_add(failed, std::memory_order_relaxed);
+        Finish(done);
+      }
+    } catch (const std::out_of_range&) {
+      // not one of ours, drop the connection
+      break;
+    }
+    // half of what is left at most, the local workers keep the rest
+    std::vector<WireTask> batch;
+    {
+      std::unique_lock<std::mutex> lock(exported_mtx_);
+      size_t take = std::min<size_t>(want, (exported_.size() + 1) / 2);
+      for (size_t i = 0; i < take; i++) {
+        batch.push_back(std::move(exported_.front()));
+        exported_.pop_front();
+      }
+    }
+    WireWriter writer;
+    writer.PutVarint(TASKS).PutVarint(batch.size());
+    for (auto& task : batch) {
+      writer.PutVarint(task.function_id).PutString(task.args);
+    }
+    if (!SendMessage(fd, writer.Data())) {
+      // the thief is gone with the batch, run it here after all, with new
+      // runners, the ones it had may have come up empty already
+      {
+        std::unique_lock<std::mutex> lock(exported_mtx_);
+        for (auto& task : batch) {
+          exported_.push_front(std::move(task));
+        }
+      }
+      local_queued_.fetch_add(batch.size(), std::memory_order_relaxed);
+      for (size_t i = 0; i < batch.size(); i++) {
+        local_.Submit([this]() { RunExported(); });
+      }
+      break;
+    }
+  }
+  // the dtor closes it, a descriptor number is not reused under its feet
+  shutdown(fd, SHUT_RDWR);
+}
+
+void ClusterPool::Steal(Peer& peer) {
+  int fd = -1;
+  while (GetStatus() == PoolStatus::RUNNING &&
+         (fd = Connect(peer.address)) < 0) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(CLUSTER_BACKOFF_MILLIS * 10));
+  }
+  if (fd < 0) {
+    return;
+  }
+  NoDelay(fd);
+  peer.fd.store(fd, std::memory_order_release);
+  if (GetStatus() == PoolStatus::SHUTDOWN) {
+    shutdown(fd, SHUT_RDWR);  // WakeWorkers() may have missed it
+  }
+
+  int in_flight = 0;
+  std::string message;
+  for (;;) {
+    PoolStatus status = GetStatus();
+    if (status == PoolStatus::SHUTDOWN) {
+      break;
+    }
+    // keep the pipeline full while hungry, and send the counts regardless
+    for (;;) {
+      bool hungry = Hungry();
+      uint64_t done = peer.done.load(std::memory_order_acquire);
+      uint64_t failed = peer.failed.load(std::memory_order_relaxed);
+      if (in_flight >= CLUSTER_PIPELINE_DEPTH ||
+          (!hungry && done == peer.reported_done)) {
+        break;
+      }
+      WireWriter writer;
+      writer.PutVarint(REQUEST)
+          .PutVarint(hungry ? CLUSTER_STEAL_BATCH : 0)
+          .PutVarint(done - peer.reported_done)
+          .PutVarint(failed - peer.reported_failed);
+      if (!SendMessage(fd, writer.Data())) {
+        in_flight = -1;
+        break;
+      }
+      peer.reported_done = done;
+      peer.reported_failed = failed;
+      in_flight++;
+    }
+    if (in_flight < 0) {
+      break;
+    }
+    if (in_flight == 0) {
+      // leave once nothing taken from the peer is left to report
+      if (status == PoolStatus::EXIT &&
+          peer.outstanding.load(std::memory_order_acquire) == 0 &&
+          peer.done.load(std::memory_order_acquire) == peer.reported_done) {
+        break;
+      }
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(CLUSTER_BACKOFF_MILLIS));
+      continue;
+    }
+    if (!ReadMessage(fd, message)) {
+      break;
+    }
+    in_flight--;
+    uint64_t count;
+    try {
+      WireReader reader(message);
+      if (reader.GetVarint() != TASKS) {
+        break;
+      }
+      count = reader.GetVarint();
+      for (uint64_t i = 0; i < count; i++) {
+        WireTask task;
+        task.function_id = static_cast<uint32_t>(reader.GetVarint());
+        task.args = reader.GetBytes();
+        RunStolen(peer, task);
+      }
+    } catch (const std::out_of_range&) {
+      break;
+    }
+    if (count == 0) {
+      // the peer is dry too, give it a moment before asking again
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(CLUSTER_BACKOFF_MILLIS));
+    }
+  }
+  peer.fd.store(-1, std::memory_order_release);
+  close(fd);
+}
+
+void ClusterPool::RunStolen(Peer& peer, WireTask& task) {
+  stolen_outstanding_.fetch_add(1, std::memory_order_relaxed);
+  peer.outstanding.fetch_add(1, std::memory_order_relaxed);
+  // not counted as a task of this node, the peer is the one waiting for it
+  local_queued_.fetch_add(1, std::memory_order_relaxed);
+  local_.Submit([this, &peer, task = std::move(task)]() {
+    local_queued_.fetch_sub(1, std::memory_order_relaxed);
+    bool ok = false;
+    try {
+      Call(task);
+      ok = true;
+    } catch (...) {
+      // reported to the peer, whose error it is
+    }
+    if (!ok) {
+      peer.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    stolen_count_.fetch_add(1, std::memory_order_relaxed);
+    // release: the failed count above goes out with this done count
+    peer.done.fetch_add(1, std::memory_order_release);
+    peer.outstanding.fetch_sub(1, std::memory_order_release);
+    stolen_outstanding_.fetch_sub(1, std::memory_order_relaxed);
+  });
+}
+
+auto ClusterPool::NodeMain(int argc, char* argv[]) -> int {
+  if (argc < 2) {
+    fprintf(stderr,
+            "usage: %s concurrency port [--bind=address] [host:port ...]\n",
+            CLUSTER_NODE_ARG);
+    return 1;
+  }
+  pid_t parent = getppid();
+  std::vector<std::string> peers;
+  std::string bind_address = CLUSTER_BIND_ADDRESS;
+  for (int i = 2; i < argc; i++) {
+    if (strncmp(argv[i], "--bind=", 7) == 0) {
+      bind_address = argv[i] + 7;
+    } else {
+      peers.emplace_back(argv[i]);
+    }
+  }
+  ClusterPool pool(atoi(argv[0]), static_cast<uint16_t>(atoi(argv[1])),
+                   std::move(peers), bind_address);
+  while (getppid() == parent) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return 0;
+}
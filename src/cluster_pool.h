@@ -0,0 +1,158 @@
+/**
+ * @file cluster_pool.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the cluster pool, one node of it
+ * every node runs a local work-stealing pool, and once that runs dry it steals
+ * batches of registered tasks from its peers over TCP; the steal requests
+ * to a peer are pipelined, the next batch is on its way while the current
+ * one runs, and carry the count of the peer's tasks finished here back to it
+ *
+ * only registered tasks, see task_registry.h, can leave the node, with
+ * their argument in the format of wire_format.h; a plain Task is a closure,
+ * it always runs on the node it was submitted to
+ *
+ * a task stolen by a peer is only counted back by that peer, so a peer that
+ * dies holding stolen tasks leaves WaitUntilFinished() of their node waiting
+ *
+ * the protocol is not authenticated, whoever reaches the port can take tasks
+ * and never report them, so a node listens on loopback only unless it is
+ * given an address of a trusted network to bind
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base_pool.h"
+#include "local_fine_pool_naive_steal.h"
+#include "task_registry.h"
+
+/* the most tasks one steal request asks a peer for */
+#define CLUSTER_STEAL_BATCH 32
+/* steal requests in flight to one peer at a time */
+#define CLUSTER_PIPELINE_DEPTH 2
+/* a peer had nothing to give, or could not be reached, ask again after */
+#define CLUSTER_BACKOFF_MILLIS 5
+/* argv[1] that turns the program into a node, see NodeMain() */
+#define CLUSTER_NODE_ARG "cluster-node"
+/* the address a node listens on unless told otherwise */
+#define CLUSTER_BIND_ADDRESS "127.0.0.1"
+/* the largest message accepted, a longer one drops the connection */
+#define CLUSTER_MAX_FRAME (64 << 20)
+/* registered tasks with longer arguments stay on their node, so that a
+ * full batch always fits a frame */
+#define CLUSTER_MAX_EXPORT_ARGS (CLUSTER_MAX_FRAME / CLUSTER_STEAL_BATCH - 64)
+
+/* a registered task and its serialized argument */
+struct WireTask {
+  uint32_t function_id;
+  std::string args;
+};
+
+class ClusterPool final : public BasePool {
+ public:
+  /**
+   * Start a node with concurrency local workers, that serves steals on port
+   * (0 picks a free one, see GetPort()) of bind_address, an IPv4 address,
+   * and steals from peers, each given as "host:port"
+   * throws std::invalid_argument for a bad bind_address and
+   * std::system_error when the port cannot be bound
+   */
+  ClusterPool(int concurrency, uint16_t port,
+              std::vector<std::string> peers = {},
+              const std::string& bind_address = CLUSTER_BIND_ADDRESS);
+
+  /* stops stealing, returns the counts owed to the peers, then drains */
+  ~ClusterPool();
+
+  /* keeps the cancellable Submit(task, token) visible */
+  using BasePool::Submit;
+
+  /* a closure, runs on this node */
+  void Submit(Task task) override;
+
+  void Submit(uint64_t key, Task task, bool ordered = false) override;
+
+  /**
+   * Submit the task registered under function_id, with its serialized
+   * argument; peers may steal it, WaitUntilFinished() waits for it anyway
+   * arguments longer than CLUSTER_MAX_EXPORT_ARGS keep it on this node
+   */
+  void Submit(uint32_t function_id, std::string args);
+
+  void WaitUntilFinished() override;
+
+  /* the port this node serves steals on */
+  auto GetPort() -> uint16_t { return port_; }
+
+  /* registered tasks of this node that peers have run */
+  auto GetRemoteCount() -> uint64_t {
+    return remote_count_.load(std::memory_order_relaxed);
+  }
+
+  /* tasks of the peers that this node has stolen and run */
+  auto GetStolenCount() -> uint64_t {
+    return stolen_count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Entry point of a node process, main() calls it when argv[1] is
+   * CLUSTER_NODE_ARG, with the concurrency, the port and the peers after it,
+   * and --bind=address among the peers to listen elsewhere than loopback
+   * serves until its parent process goes away
+   * @return the process exit status
+   */
+  static auto NodeMain(int argc, char* argv[]) -> int;
+
+ private:
+  /* a peer this node steals from, over a connection of its own */
+  struct Peer;
+
+  void WakeWorkers() override;
+
+  /* count a task of this node finished, here or on a peer */
+  void Finish(uint64_t count);
+  /* run one exported task, unless a peer has stolen it meanwhile */
+  void RunExported();
+  /* whether this node has run out of work and should steal */
+  auto Hungry() -> bool;
+
+  void Listen();
+  void Serve(int fd);
+  void Steal(Peer& peer);
+  void RunStolen(Peer& peer, WireTask& task);
+
+  uint16_t port_;
+  int listen_fd_;
+  std::thread listener_;
+  std::mutex serve_mtx_;
+  std::vector<int> serve_fds_;           // guarded by serve_mtx_
+  std::vector<std::thread> servers_;     // guarded by serve_mtx_
+  std::vector<std::unique_ptr<Peer>> peers_;
+
+  /* registered tasks not run yet, the local runners take the newest,
+   * thieves the oldest */
+  std::mutex exported_mtx_;
+  std::deque<WireTask> exported_;
+
+  /* closures handed to local_ that no worker has picked up yet */
+  std::atomic<int64_t> local_queued_{0};
+  std::atomic<int64_t> stolen_outstanding_{0};
+  std::atomic<uint64_t> remote_count_{0};
+  std::atomic<uint64_t> stolen_count_{0};
+  std::mutex mtx_count_;
+  std::condition_variable cv_count_;
+
+  /* last, so it is drained before anything its tasks touch goes away */
+  LocalFinePoolNaiveSteal local_;
+};
@@ -18,7 +18,9 @@ class DummyPool : public BasePool {
   DummyPool(int concurrency, PoolType pool_type)
       : BasePool(concurrency, pool_type){};
 
-  void Submit(Task task) override { task(); }
+  using BasePool::Submit;
+
+  void Submit(Task task) override { RunTask(task); }
 
   void WaitUntilFinished() override {}
 };
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * @file elastic_pool.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the elastic threadpool
+ * workers share one work queue, so a retiring worker never holds tasks
+ * that would need to be handed off to the others
+ * a worker blocked in a BlockingRegion is not counted as active, which lets
+ * a spare worker keep the cores busy in the meantime
+ */
+
+#include "elastic_pool.h"
+
+ElasticPool::ElasticPool(int min_concurrency, int max_concurrency,
+                         PoolType pool_type,
+                         std::chrono::milliseconds idle_timeout)
+    : BasePool(max_concurrency, pool_type),
+      min_concurrency_(min_concurrency),
+      idle_timeout_(idle_timeout),
+      threads_(max_concurrency) {
+  assert(0 < min_concurrency && min_concurrency <= max_concurrency);
+  for (int i = max_concurrency - 1; i >= 0; i--) {
+    free_slots_.push_back(i);
+  }
+  std::unique_lock<std::mutex> lock(mtx_);
+  for (int i = 0; i < min_concurrency_; i++) {
+    SpawnWorker();
+  }
+}
+
+ElasticPool::~ElasticPool() {
+  // force signal so that the workers above the minimum also leave
+  Join();
+}
+
+void ElasticPool::JoinWorkers() {
+  // harvest all worker threads, retired ones have already returned
+  for (auto& worker : threads_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  std::unique_lock<std::mutex> lock(mtx_);
+  cancelled_count_.fetch_add(task_queue_.size(), std::memory_order_relaxed);
+  task_queue_ = {};
+}
+
+void ElasticPool::SpawnWorker() {
+  if (free_slots_.empty()) {
+    // compensating for blocked workers may exceed max_concurrency threads
+    free_slots_.push_back(static_cast<int>(threads_.size()));
+    threads_.emplace_back();
+  }
+  int slot = free_slots_.back();
+  free_slots_.pop_back();
+  if (threads_[slot].joinable()) {
+    // the previous owner of this slot retired and released mtx_ already
+    threads_[slot].join();
+  }
+  live_count_++;
+  // idle until it takes a task, also while parked until Begin(), so that a
+  // new or parked worker is not taken for a busy one and grown past
+  idle_count_++;
+  threads_[slot] = std::thread([this, slot]() { WorkerLoop(slot); });
+}
+
+auto ElasticPool::Overloaded() -> bool {
+  // only while running, in PREPARE the workers are parked, not busy
+  return GetStatus() == PoolStatus::RUNNING && !task_queue_.empty() &&
+         idle_count_ == 0 && live_count_ - blocked_count_ < concurrency_;
+}
+
+void ElasticPool::WorkerLoop(int slot) {
+  BindWorker(slot);
+  // in BATCH mode, wait for signal
+  WaitForBegin();
+  std::unique_lock<std::mutex> lock(mtx_);
+  // counted idle by SpawnWorker(), the loop counts it again
+  idle_count_--;
+  // enter main loop of polling and execution
+  while (true) {
+    // wait for either a task available, or exit signal, or idle timeout
+    idle_count_++;
+    bool has_work = cv_.wait_for(lock, idle_timeout_, [this]() -> bool {
+      return GetStatus() != PoolStatus::RUNNING || !task_queue_.empty();
+    });
+    idle_count_--;
+    if (!has_work && live_count_ <= min_concurrency_) {
+      // keep the minimum number of workers around
+      continue;
+    }
+    if (task_queue_.empty() || GetStatus() == PoolStatus::SHUTDOWN) {
+      // either idle for too long, or this pool is about to be destroyed
+      // queue is empty under mtx_ unless the pool abandons it on purpose
+      live_count_--;
+      free_slots_.push_back(slot);
+      return;
+    }
+    Task next_task = std::move(task_queue_.front());
+    task_queue_.pop();
+    if (Overloaded()) {
+      // a backlog left behind, e.g. the one queued before Begin()
+      SpawnWorker();
+    }
+    lock.unlock();
+    RunTask(next_task);
+    // finish under mtx_: a submitter woken by it finds this worker idle
+    // again, instead of busy, and does not grow the pool for nothing
+    lock.lock();
+    if (CountFinish()) {
+      // notify the WaitUntilFinished() caller
+      // under its mutex so that the wakeup cannot slip in before it waits
+      std::unique_lock<std::mutex> count_lock(mtx_count_);
+      cv_count_.notify_all();
+    }
+    if (live_count_ - blocked_count_ > concurrency_) {
+      // a compensated worker came back from blocking, one of us is surplus
+      live_count_--;
+      free_slots_.push_back(slot);
+      return;
+    }
+  }
+}
+
+void ElasticPool::Submit(Task task) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    task_queue_.push(std::move(task));
+    if (Overloaded()) {
+      SpawnWorker();
+    }
+  }
+  cv_.notify_one();
+}
+
+void ElasticPool::WaitUntilFinished() {
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
+}
+
+void ElasticPool::WakeWorkers() {
+  {
+    // pass through the mutex so no worker is between predicate and sleep
+    std::unique_lock<std::mutex> lock(mtx_);
+  }
+  cv_.notify_all();  // wake up sleeping worker
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
+}
+
+void ElasticPool::EnterBlocking() {
+  if (CurrentWorkerId() < 0) {
+    // an external thread blocking does not take a worker away
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    blocked_count_++;
+    if (!Overloaded()) {
+      // nothing to compensate for now, Submit() grows the pool if needed
+      return;
+    }
+    SpawnWorker();
+  }
+  cv_.notify_one();
+}
+
+void ElasticPool::LeaveBlocking() {
+  if (CurrentWorkerId() < 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mtx_);
+  blocked_count_--;
+}
+
+auto ElasticPool::GetLiveCount() -> int {
+  std::unique_lock<std::mutex> lock(mtx_);
+  return live_count_;
+}
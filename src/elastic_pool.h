@@ -0,0 +1,88 @@
+/**
+ * @file elastic_pool.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the elastic threadpool
+ * which grows the worker count under load and retires idle workers
+ * between a lower and upper thread bound, and compensates for workers
+ * that are blocked inside a BlockingRegion
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "base_pool.h"
+
+class ElasticPool final : public BasePool {
+ public:
+  /*
+   * The pool starts with min_concurrency workers and never exceeds
+   * max_concurrency, which is what GetConcurrency() reports
+   * a worker idle for longer than idle_timeout retires if above the minimum
+   */
+  ElasticPool(int min_concurrency, int max_concurrency, PoolType pool_type,
+              std::chrono::milliseconds idle_timeout =
+                  std::chrono::milliseconds(100));
+
+  ~ElasticPool();
+
+  /* keyed submission falls back to plain Submit, there is one queue */
+  using BasePool::Submit;
+
+  void Submit(Task task) override;
+
+  void WaitUntilFinished() override;
+
+  /*
+   * A worker entering a blocking region no longer counts as active
+   * a spare worker is started if there is queued work to keep cores busy
+   * and the surplus worker retires after the region is left
+   */
+  void EnterBlocking() override;
+
+  void LeaveBlocking() override;
+
+  /* how many worker threads are alive at the moment */
+  auto GetLiveCount() -> int;
+
+ private:
+  /* start a new worker in a free slot, requires holding mtx_ */
+  void SpawnWorker();
+
+  /*
+   * Whether to grow: tasks are waiting while every worker is busy and the
+   * pool is below its bound, requires holding mtx_
+   */
+  auto Overloaded() -> bool;
+
+  void WorkerLoop(int slot);
+
+  void WakeWorkers() override;
+  void JoinWorkers() override;
+
+  int min_concurrency_;
+  std::chrono::milliseconds idle_timeout_;
+
+  /* worker slots, retired slots are reused on growth */
+  std::vector<std::thread> threads_;
+  std::vector<int> free_slots_;
+  int live_count_{0};     // guarded by mtx_
+  int idle_count_{0};     // guarded by mtx_
+  int blocked_count_{0};  // guarded by mtx_
+
+  std::queue<Task> task_queue_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+
+  std::mutex mtx_count_;
+  std::condition_variable cv_count_;
+};
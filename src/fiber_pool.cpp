@@ -0,0 +1,446 @@
+/**
+ * @file fiber_pool.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the fiber threadpool
+ * fibers are ucontext contexts on mmap'ed stacks with a guard page below,
+ * a finished fiber keeps its stack and is reused for the next task
+ * a fiber is pinned to the worker that started it: it never resumes on
+ * another thread, so thread_local state seen by a task stays consistent;
+ * only a task not started yet moves, when an idle worker steals it
+ */
+
+#include "fiber_pool.h"
+
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include <new>
+#include <queue>
+#include <utility>
+
+// ThreadSanitizer has to be told about every stack switch
+#if defined(__SANITIZE_THREAD__)
+#define ZORRO_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define ZORRO_TSAN 1
+#endif
+#endif
+#ifdef ZORRO_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+// and AddressSanitizer about the stack it is on
+#if defined(__SANITIZE_ADDRESS__)
+#define ZORRO_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ZORRO_ASAN 1
+#endif
+#endif
+#ifdef ZORRO_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+enum class FiberAction { FINISHED, YIELDED, SLEEPING, PARKED };
+
+struct FiberContext {
+  explicit FiberContext(size_t stack_size) : stack_size(stack_size) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    mapping_size = stack_size + page;
+    mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    // the stack grows down, an overflow runs into this page and faults
+    mprotect(mapping, page, PROT_NONE);
+    stack = static_cast<char*>(mapping) + page;
+#ifdef ZORRO_TSAN
+    tsan_fiber = __tsan_create_fiber(0);
+#endif
+  }
+
+  ~FiberContext() {
+#ifdef ZORRO_TSAN
+    __tsan_destroy_fiber(tsan_fiber);
+#endif
+    munmap(mapping, mapping_size);
+  }
+
+  FiberContext(const FiberContext&) = delete;
+  FiberContext& operator=(const FiberContext&) = delete;
+
+  ucontext_t context;
+  void* mapping;
+  size_t mapping_size;
+  char* stack;
+  size_t stack_size;
+
+  void* tsan_fiber{nullptr};
+  void* asan_fake_stack{nullptr};
+
+  Task task;
+  FiberPool::Worker* owner{nullptr};
+  std::chrono::steady_clock::time_point wake_at;
+};
+
+/* orders the sleeping fibers by who wakes up first */
+struct WakesLater {
+  bool operator()(const FiberContext* a, const FiberContext* b) const {
+    return a->wake_at > b->wake_at;
+  }
+};
+
+struct FiberPool::Worker {
+  explicit Worker(FiberPool& pool) : pool(pool) {}
+
+  FiberPool& pool;
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<Task> tasks;           // guarded by mtx, not started yet
+  std::deque<FiberContext*> ready;  // guarded by mtx, suspended and runnable
+
+  /* below is only touched by the worker thread itself */
+  ucontext_t scheduler;
+  void* tsan_scheduler{nullptr};
+  void* asan_fake_stack{nullptr};
+  const void* asan_stack_bottom{nullptr};
+  size_t asan_stack_size{0};
+  FiberContext* current{nullptr};
+  FiberAction action{FiberAction::FINISHED};
+  int live_fibers{0};  // started and not finished yet
+  std::priority_queue<FiberContext*, std::vector<FiberContext*>, WakesLater>
+      sleepers;
+  std::vector<FiberContext*> free_fibers;
+  std::vector<std::unique_ptr<FiberContext>> fibers;  // owns every stack
+};
+
+FiberPool::FiberPool(int concurrency, PoolType pool_type, size_t stack_size)
+    : BasePool(concurrency, pool_type), stack_size_(stack_size) {
+  for (int i = 0; i < concurrency; i++) {
+    workers_.emplace_back(new Worker(*this));
+  }
+  // create thread worker
+  for (int i = 0; i < concurrency; i++) {
+    threads_.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+FiberPool::~FiberPool() {
+  // the stacks go with the workers
+  Join();
+}
+
+void FiberPool::JoinWorkers() {
+  // harvest all worker threads
+  for (auto& worker : threads_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // only a Shutdown() leaves tasks or started fibers behind, count them
+  for (auto& worker : workers_) {
+    std::unique_lock<std::mutex> lock(worker->mtx);
+    cancelled_count_.fetch_add(worker->tasks.size() + worker->live_fibers,
+                               std::memory_order_relaxed);
+    worker->tasks.clear();
+    worker->ready.clear();
+    worker->sleepers = {};
+    worker->live_fibers = 0;
+  }
+}
+
+void FiberPool::WorkerLoop(int worker_id) {
+  Worker& worker = *workers_[worker_id];
+  BindWorker(worker_id);
+  tls_worker_ = &worker;
+#ifdef ZORRO_TSAN
+  worker.tsan_scheduler = __tsan_get_current_fiber();
+#endif
+  // in BATCH mode, wait for signal
+  WaitForBegin();
+  auto has_work = [this, &worker]() -> bool {
+    return GetStatus() == PoolStatus::SHUTDOWN ||
+           (GetStatus() == PoolStatus::EXIT && worker.live_fibers == 0) ||
+           !worker.ready.empty() || !worker.tasks.empty();
+  };
+  // enter main loop of scheduling
+  while (true) {
+    FiberContext* fiber = nullptr;
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(worker.mtx);
+      auto now = std::chrono::steady_clock::now();
+      while (!worker.sleepers.empty() &&
+             worker.sleepers.top()->wake_at <= now) {
+        worker.ready.push_back(worker.sleepers.top());
+        worker.sleepers.pop();
+      }
+      if (!has_work()) {
+        lock.unlock();
+        if (StealTask(worker_id, task)) {
+          RunFiber(worker, StartFiber(worker, std::move(task)));
+          continue;
+        }
+        lock.lock();
+        // sleep until a task arrives, a fiber is resumed or a sleep is over
+        if (worker.sleepers.empty()) {
+          worker.cv.wait(lock, has_work);
+        } else {
+          worker.cv.wait_until(lock, worker.sleepers.top()->wake_at, has_work);
+        }
+        continue;
+      }
+      if (GetStatus() == PoolStatus::SHUTDOWN) {
+        // suspended fibers are abandoned along with the queued tasks
+        return;
+      }
+      if (!worker.ready.empty()) {
+        // tasks already started go first, they hold on to a stack
+        fiber = worker.ready.front();
+        worker.ready.pop_front();
+      } else if (!worker.tasks.empty()) {
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+      } else {
+        // EXIT and every fiber of this worker has finished
+        return;
+      }
+    }
+    if (fiber == nullptr) {
+      fiber = StartFiber(worker, std::move(task));
+    }
+    RunFiber(worker, fiber);
+  }
+}
+
+auto FiberPool::StealTask(int thief, Task& task) -> bool {
+  for (int i = 1; i < concurrency_; i++) {
+    Worker& victim = *workers_[(thief + i) % concurrency_];
+    std::unique_lock<std::mutex> lock(victim.mtx);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+auto FiberPool::StartFiber(Worker& worker, Task task) -> FiberContext* {
+  FiberContext* fiber;
+  if (!worker.free_fibers.empty()) {
+    fiber = worker.free_fibers.back();
+    worker.free_fibers.pop_back();
+  } else {
+    worker.fibers.emplace_back(new FiberContext(stack_size_));
+    fiber = worker.fibers.back().get();
+    fiber->owner = &worker;
+  }
+  fiber->task = std::move(task);
+  getcontext(&fiber->context);
+  fiber->context.uc_stack.ss_sp = fiber->stack;
+  fiber->context.uc_stack.ss_size = fiber->stack_size;
+  fiber->context.uc_link = nullptr;
+  makecontext(&fiber->context, FiberMain, 0);
+  worker.live_fibers++;
+  return fiber;
+}
+
+void FiberPool::RunFiber(Worker& worker, FiberContext* fiber) {
+  worker.current = fiber;
+#ifdef ZORRO_TSAN
+  __tsan_switch_to_fiber(fiber->tsan_fiber, 0);
+#endif
+#ifdef ZORRO_ASAN
+  __sanitizer_start_switch_fiber(&worker.asan_fake_stack, fiber->stack,
+                                 fiber->stack_size);
+#endif
+  swapcontext(&worker.scheduler, &fiber->context);
+#ifdef ZORRO_ASAN
+  __sanitizer_finish_switch_fiber(worker.asan_fake_stack, nullptr, nullptr);
+#endif
+  worker.current = nullptr;
+  switch (worker.action) {
+    case FiberAction::FINISHED: {
+      fiber->task = nullptr;
+      worker.free_fibers.push_back(fiber);
+      worker.live_fibers--;
+      if (CountFinish()) {
+        // notify the WaitUntilFinished() caller
+        // under its mutex so that the wakeup cannot slip in before it waits
+        std::unique_lock<std::mutex> lock(mtx_count_);
+        cv_count_.notify_all();
+      }
+      break;
+    }
+    case FiberAction::YIELDED: {
+      std::unique_lock<std::mutex> lock(worker.mtx);
+      worker.ready.push_back(fiber);
+      break;
+    }
+    case FiberAction::SLEEPING:
+      worker.sleepers.push(fiber);
+      break;
+    case FiberAction::PARKED:
+      // whoever parked it calls Resume() later
+      break;
+  }
+}
+
+void FiberPool::FiberMain() {
+  Worker* worker = tls_worker_;
+#ifdef ZORRO_ASAN
+  // a fresh fiber has no fake stack yet, learn where the scheduler stack is
+  __sanitizer_finish_switch_fiber(nullptr, &worker->asan_stack_bottom,
+                                  &worker->asan_stack_size);
+#endif
+  // an exception must not unwind past the start of the fiber stack
+  worker->pool.RunTask(worker->current->task);
+  SwitchOut(FiberAction::FINISHED);
+  // never resumed, the next task starts over with a fresh context
+}
+
+void FiberPool::SwitchOut(FiberAction action) {
+  Worker* worker = tls_worker_;
+  FiberContext* fiber = worker->current;
+  worker->action = action;
+#ifdef ZORRO_TSAN
+  __tsan_switch_to_fiber(worker->tsan_scheduler, 0);
+#endif
+#ifdef ZORRO_ASAN
+  // a finished fiber never comes back, its fake stack can go
+  __sanitizer_start_switch_fiber(
+      action == FiberAction::FINISHED ? nullptr : &fiber->asan_fake_stack,
+      worker->asan_stack_bottom, worker->asan_stack_size);
+#endif
+  swapcontext(&fiber->context, &worker->scheduler);
+#ifdef ZORRO_ASAN
+  __sanitizer_finish_switch_fiber(fiber->asan_fake_stack,
+                                  &worker->asan_stack_bottom,
+                                  &worker->asan_stack_size);
+#endif
+}
+
+void FiberPool::Resume(FiberContext* fiber) {
+  Worker* worker = fiber->owner;
+  {
+    std::unique_lock<std::mutex> lock(worker->mtx);
+    worker->ready.push_back(fiber);
+  }
+  worker->cv.notify_one();
+}
+
+void FiberPool::Submit(Task task) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  int id = CurrentWorkerId();
+  if (id >= 0) {
+    // the submitting worker is awake, it needs no notify
+    Worker& own = *workers_[id];
+    std::unique_lock<std::mutex> lock(own.mtx);
+    if (own.tasks.size() < FIBER_SPILL_DEPTH) {
+      own.tasks.push_back(std::move(task));
+      return;
+    }
+  }
+  uint64_t robin = next_worker_.fetch_add(1, std::memory_order_relaxed);
+  Worker& worker = *workers_[robin % concurrency_];
+  {
+    std::unique_lock<std::mutex> lock(worker.mtx);
+    worker.tasks.push_back(std::move(task));
+  }
+  worker.cv.notify_one();
+}
+
+void FiberPool::WaitUntilFinished() {
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
+}
+
+void FiberPool::WakeWorkers() {
+  for (auto& worker : workers_) {
+    {
+      // pass through the mutex so no worker is between predicate and sleep
+      std::unique_lock<std::mutex> lock(worker->mtx);
+    }
+    worker->cv.notify_all();
+  }
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
+}
+
+auto Fiber::Active() -> bool {
+  return FiberPool::tls_worker_ != nullptr &&
+         FiberPool::tls_worker_->current != nullptr;
+}
+
+void Fiber::Yield() {
+  if (!Active()) {
+    std::this_thread::yield();
+    return;
+  }
+  FiberPool::SwitchOut(FiberAction::YIELDED);
+}
+
+void Fiber::Sleep(std::chrono::nanoseconds duration) {
+  if (!Active()) {
+    std::this_thread::sleep_for(duration);
+    return;
+  }
+  FiberPool::tls_worker_->current->wake_at =
+      std::chrono::steady_clock::now() + duration;
+  FiberPool::SwitchOut(FiberAction::SLEEPING);
+}
+
+void FiberMutex::lock() {
+  std::unique_lock<std::mutex> lock(guard_);
+  if (!locked_) {
+    locked_ = true;
+    return;
+  }
+  if (!Fiber::Active()) {
+    lock.unlock();
+    while (!try_lock()) {
+      std::this_thread::yield();
+    }
+    return;
+  }
+  waiters_.push_back(FiberPool::tls_worker_->current);
+  lock.unlock();
+  // unlock() may resume this fiber before it has switched out, which is fine:
+  // only this same worker picks it up again, after the switch
+  FiberPool::SwitchOut(FiberAction::PARKED);
+  // unlock() handed the ownership over without clearing locked_
+}
+
+auto FiberMutex::try_lock() -> bool {
+  std::unique_lock<std::mutex> lock(guard_);
+  if (locked_) {
+    return false;
+  }
+  locked_ = true;
+  return true;
+}
+
+void FiberMutex::unlock() {
+  FiberContext* next;
+  {
+    std::unique_lock<std::mutex> lock(guard_);
+    if (waiters_.empty()) {
+      locked_ = false;
+      return;
+    }
+    next = waiters_.front();
+    waiters_.pop_front();
+  }
+  FiberPool::Resume(next);
+}
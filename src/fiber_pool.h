@@ -0,0 +1,141 @@
+/**
+ * @file fiber_pool.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the fiber threadpool
+ * every task runs on its own small stack, so a task that yields, sleeps
+ * or waits for a FiberMutex suspends just itself and its worker moves on
+ * to other tasks, while the task body stays plain synchronous code
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base_pool.h"
+
+/* usable stack of every fiber, pages are only committed when touched */
+#define FIBER_STACK_SIZE (256 * 1024)
+/* tasks a worker keeps of what it submits, the rest is dealt out */
+#define FIBER_SPILL_DEPTH 32
+
+struct FiberContext;
+
+/* why a fiber switched back to its scheduler, defined in fiber_pool.cpp */
+enum class FiberAction;
+
+class FiberPool final : public BasePool {
+ public:
+  FiberPool(int concurrency, PoolType pool_type,
+            size_t stack_size = FIBER_STACK_SIZE);
+
+  ~FiberPool();
+
+  /* keyed submission falls back to plain Submit */
+  using BasePool::Submit;
+
+  /*
+   * A task submitted from one of the workers stays on that worker, unless
+   * FIBER_SPILL_DEPTH tasks wait there already; others are dealt out round
+   * robin, and an idle worker steals the ones not started yet
+   */
+  void Submit(Task task) override;
+
+  /* a suspended task counts as unfinished until it has returned */
+  void WaitUntilFinished() override;
+
+ private:
+  friend class Fiber;
+  friend class FiberMutex;
+  friend struct FiberContext;
+
+  /* per worker scheduler state, defined in fiber_pool.cpp */
+  struct Worker;
+
+  void WorkerLoop(int worker_id);
+
+  /* take a task another worker has not started yet */
+  auto StealTask(int thief, Task& task) -> bool;
+
+  /* a fiber with a pooled stack, set up to run task from the start */
+  auto StartFiber(Worker& worker, Task task) -> FiberContext*;
+
+  /* switch into fiber until it finishes or suspends itself */
+  void RunFiber(Worker& worker, FiberContext* fiber);
+
+  void WakeWorkers() override;
+  void JoinWorkers() override;
+
+  /* entry point of every fiber */
+  static void FiberMain();
+
+  /* switch from the running fiber back to its worker's scheduler */
+  static void SwitchOut(FiberAction action);
+
+  /* hand a parked fiber back to the worker it is pinned to */
+  static void Resume(FiberContext* fiber);
+
+  size_t stack_size_;
+  std::atomic<uint64_t> next_worker_{0};
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mtx_count_;
+  std::condition_variable cv_count_;
+
+  /* the scheduler state of the worker running on this thread, if any */
+  inline static thread_local Worker* tls_worker_ = nullptr;
+};
+
+/*
+ * Suspension points for the task that is currently running
+ * inside a FiberPool task they suspend only the fiber, anywhere else they
+ * fall back to the thread versions, so the same task body runs on any pool
+ */
+class Fiber {
+ public:
+  /* whether the caller runs on a fiber of a FiberPool */
+  static auto Active() -> bool;
+
+  /* let the other runnable tasks of this worker go first */
+  static void Yield();
+
+  /* suspend for at least duration */
+  static void Sleep(std::chrono::nanoseconds duration);
+};
+
+/*
+ * Mutex that parks a waiting fiber instead of its worker
+ * ownership passes straight to the longest waiting fiber on unlock()
+ * callers outside a fiber spin with std::this_thread::yield()
+ * meets the Lockable requirements, i.e. works with std::lock_guard
+ */
+class FiberMutex {
+ public:
+  FiberMutex() = default;
+
+  void lock();
+
+  auto try_lock() -> bool;
+
+  void unlock();
+
+  FiberMutex(const FiberMutex&) = delete;
+  FiberMutex& operator=(const FiberMutex&) = delete;
+
+ private:
+  std::mutex guard_;
+  bool locked_{false};                  // guarded by guard_
+  std::deque<FiberContext*> waiters_;  // guarded by guard_
+};
@@ -15,25 +15,40 @@
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "base_pool.h"
+#include "queue_locks.h"
 
-template <typename T>
+/*
+ * Two-lock queue, producers only contend on the tail lock and consumers
+ * on the head lock; Lock is std::mutex or one of queue_locks.h, with a
+ * CombiningLock the pushes of contending producers are applied in batches
+ */
+template <typename T, typename Lock = std::mutex>
 class fine_queue {
  private:
   struct node {
     T data;
     node *next;
+    node *prev;
   };
-  std::mutex head_mutex;
+  Lock head_mutex;
   node *head;
-  std::mutex tail_mutex;
-  node *tail;
+  Lock tail_mutex;
+  /*
+   * written under tail_mutex with a release store, once the node it leaves
+   * behind is complete, and read by the consumers with an acquire load
+   * instead of the lock, which would make every pop contend with the pushes
+   */
+  std::atomic<node *> tail;
+
+  node *get_tail() { return tail.load(std::memory_order_acquire); }
 
   node *pop_head() {
-    std::lock_guard<std::mutex> head_lock(head_mutex);
-    if (head == tail) {
+    std::lock_guard<Lock> head_lock(head_mutex);
+    if (head == get_tail()) {
       return nullptr;
     }
     node *old_head = head;
@@ -43,6 +58,15 @@ class fine_queue {
 
  public:
   fine_queue() : head(new node), tail(head) {}
+  /* free whatever has not been popped, e.g. tasks abandoned on Shutdown() */
+  ~fine_queue() {
+    node *last = tail.load(std::memory_order_relaxed);
+    while (head != nullptr) {
+      node *old_head = head;
+      head = old_head == last ? nullptr : old_head->next;
+      delete old_head;
+    }
+  }
   fine_queue(const fine_queue &other) = delete;
   fine_queue &operator=(const fine_queue &other) = delete;
   bool pop(T &task) {
@@ -54,12 +78,85 @@ class fine_queue {
     }
     return false;
   }
+  /*
+   * Append up to max_count of the oldest items to out, in order
+   * the run of nodes is cut off under head_mutex once, and moved out and
+   * freed after it is released
+   * @return how many items have been appended
+   */
+  size_t pop_bulk(std::vector<T> &out, size_t max_count) {
+    node *first;
+    size_t count = 0;
+    {
+      std::lock_guard<Lock> head_lock(head_mutex);
+      // nodes before this tail are complete, only the tail keeps moving
+      node *stop = get_tail();
+      first = head;
+      while (count < max_count && head != stop) {
+        head = head->next;
+        count++;
+      }
+    }
+    // the detached run is private now, pop_back() never goes past head
+    for (size_t i = 0; i < count; i++) {
+      node *next = first->next;
+      out.push_back(std::move(first->data));
+      delete first;
+      first = next;
+    }
+    return count;
+  }
+  /* drop every queued item, @return how many were dropped */
+  size_t clear() {
+    std::vector<T> dropped;
+    size_t count = 0;
+    while (size_t n = pop_bulk(dropped, 64)) {
+      count += n;
+      dropped.clear();
+    }
+    return count;
+  }
+  /* take the newest item instead of the oldest one */
+  bool pop_back(T &task) {
+    node *old_tail;
+    {
+      // lock order is always head before tail
+      std::lock_guard<Lock> head_lock(head_mutex);
+      std::lock_guard<Lock> tail_lock(tail_mutex);
+      old_tail = tail.load(std::memory_order_relaxed);
+      if (head == old_tail) {
+        return false;
+      }
+      // the last real node becomes the new dummy tail
+      node *last = old_tail->prev;
+      task = std::move(last->data);
+      last->next = nullptr;
+      tail.store(last, std::memory_order_release);
+    }
+    delete old_tail;
+    return true;
+  }
+  /* a hint only, another thread may push or pop right after */
+  bool empty() {
+    std::lock_guard<Lock> head_lock(head_mutex);
+    return head == get_tail();
+  }
   void push(T new_value) {
     node *new_tail = new node;
-    std::lock_guard<std::mutex> tail_lock(tail_mutex);
-    tail->data = std::move(new_value);
-    tail->next = new_tail;
-    tail = new_tail;
+    auto append = [this, &new_value, new_tail]() {
+      // only the tail_mutex holder moves the tail, a relaxed load will do
+      node *old_tail = tail.load(std::memory_order_relaxed);
+      old_tail->data = std::move(new_value);
+      old_tail->next = new_tail;
+      new_tail->prev = old_tail;
+      tail.store(new_tail, std::memory_order_release);
+    };
+    if constexpr (std::is_same_v<Lock, CombiningLock>) {
+      tail_mutex.combine(append);
+    } else {
+      std::lock_guard<Lock> tail_lock(tail_mutex);
+      append();
+    }
   }
 };
 
@@ -67,7 +164,15 @@ class fine_queue {
  * false-sharing */
 typedef struct PaddedResourceFine {
   fine_queue<Task> queue;
+  /* ordered keyed tasks, only ever popped by the owning worker */
+  fine_queue<Task> pinned;
   std::mutex pop_mtx;
-  std::mutex push_mtx;
   std::condition_variable cv;
 } PaddedResourceFine __attribute__((aligned(256)));
+
+/*
+ * How many tasks a worker takes off its own queue at once
+ * they are run from a private buffer where thieves cannot see them,
+ * so it stays small
+ */
+#define POP_BATCH_SIZE 8
@@ -11,15 +11,17 @@
 
 #include "global_pool.h"
 
+#include <cinttypes>
 #include <iostream>
 GlobalPool::GlobalPool(int concurrency, PoolType pool_type)
     : BasePool(concurrency, pool_type) {
   // create thread worker
   for (auto i = 0; i < GetConcurrency(); i++) {
-    threads_.emplace_back([this]() {
+    threads_.emplace_back([this, id = i]() {
+      // one shared queue, the ID only tells the workers apart
+      BindWorker(id);
       // in BATCH mode, wait for signal
-      while (status_ == PoolStatus::PREPARE) {
-      };
+      WaitForBegin();
       // enter main loop of polling and execution
       while (true) {
         Task next_task;
@@ -27,20 +29,21 @@ GlobalPool::GlobalPool(int concurrency, PoolType pool_type)
           // wait for either a task available, or exit signal
           std::unique_lock<std::mutex> lock(mtx_);
           cv_.wait(lock, [this]() -> bool {
-            return status_ == PoolStatus::EXIT || !task_queue_.empty();
+            return GetStatus() != PoolStatus::RUNNING || !task_queue_.empty();
           });
-          if (task_queue_.empty() && status_ == PoolStatus::EXIT) {
+          if (GetStatus() == PoolStatus::SHUTDOWN ||
+              (task_queue_.empty() && GetStatus() == PoolStatus::EXIT)) {
             // this pool is about to be destroyed
             return;
           }
           next_task = task_queue_.front();
           task_queue_.pop();
         }
-        next_task();
-        // there is no add_fetch available
-        int post_increment = finish_count_.fetch_add(1) + 1;
-        if (post_increment == submit_count_) {
+        RunTask(next_task);
+        if (CountFinish()) {
           // notify the WaitUntilFinished() caller
+          // under its mutex so that the wakeup cannot slip in before it waits
+          std::unique_lock<std::mutex> lock(mtx_count_);
           cv_count_.notify_all();
         }
       }
@@ -49,38 +52,51 @@ GlobalPool::GlobalPool(int concurrency, PoolType pool_type)
 }
 
 GlobalPool::~GlobalPool() {
-  {
-    std::unique_lock<std::mutex> lock(mtx_);
-    std::queue<Task> empty_queue;
-    task_queue_.swap(empty_queue);
-  }
+  // like the other pools, the workers run the queue dry before leaving
+  Join();
+}
+
+void GlobalPool::JoinWorkers() {
   // harvest all worker threads
   for (auto& worker : threads_) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
   }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  cancelled_count_.fetch_add(task_queue_.size(), std::memory_order_relaxed);
+  task_queue_ = {};
 }
 
 void GlobalPool::Submit(Task task) {
-  assert(status_ != PoolStatus::EXIT);
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // count before the task becomes visible, so a fast worker never
+  // lets finish_count_ catch up with a stale submit_count_
+  CountSubmit();
   {
     std::unique_lock<std::mutex> lock(mtx_);
     task_queue_.push(std::move(task));
   }
-  submit_count_.fetch_add(1);  // atomic add
   cv_.notify_one();
 }
 
 void GlobalPool::WaitUntilFinished() {
   std::unique_lock<std::mutex> lock(mtx_count_);
-  cv_count_.wait(lock,
-                 [this]() -> bool { return submit_count_ == finish_count_; });
-  finish_count_.store(0);
-  submit_count_.store(0);
-  printf("task count: %d\n", finish_count_.load());
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
+  printf("task count: %" PRIu64 "\n",
+         finish_count_.load(std::memory_order_relaxed));
   fflush(stdout);
 }
 
-void GlobalPool::Exit() {
-  status_ = PoolStatus::EXIT;
+void GlobalPool::WakeWorkers() {
+  {
+    // pass through the mutex so no worker is between predicate and sleep
+    std::unique_lock<std::mutex> lock(mtx_);
+  }
   cv_.notify_all();  // wake up sleeping worker
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
 }
\ No newline at end of file
@@ -26,15 +26,16 @@ class GlobalPool final : public BasePool {
 
   ~GlobalPool();
 
+  /* keyed submission falls back to plain Submit, there is one queue */
+  using BasePool::Submit;
+
   void Submit(Task task) override;
 
   void WaitUntilFinished() override;
 
-  void Exit();
-
  private:
-  std::atomic<int> submit_count_{0};
-  std::atomic<int> finish_count_{0};
+  void WakeWorkers() override;
+  void JoinWorkers() override;
 
   std::vector<std::thread> threads_;
   std::queue<Task> task_queue_;
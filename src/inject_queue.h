@@ -0,0 +1,161 @@
+/**
+ * @file inject_queue.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the injection queue
+ * through which threads outside a pool submit tasks to its workers
+ * producers never take a lock, workers drain it in batches
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*
+ * Bounded multi-producer multi-consumer ring, every cell carries a sequence
+ * number telling which lap of the ring it is ready for. A producer claims a
+ * cell by advancing enqueue_pos, a consumer claims a whole run of filled cells
+ * by advancing dequeue_pos once. When the ring is full the push falls back to
+ * a locked overflow list so that the queue as a whole stays unbounded.
+ */
+template <typename T>
+class inject_queue {
+ private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+  /* producer and consumer cursors on separate cache lines */
+  alignas(64) std::atomic<size_t> enqueue_pos{0};
+  alignas(64) std::atomic<size_t> dequeue_pos{0};
+  alignas(64) size_t mask;
+  std::unique_ptr<cell[]> buffer;
+
+  std::atomic<size_t> overflow_size{0};
+  std::mutex overflow_mutex;
+  std::deque<T> overflow;
+
+  bool try_push_ring(T &new_value) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    cell *target;
+    while (true) {
+      target = &buffer[pos & mask];
+      size_t seq = target->sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // the cell still holds an item from the previous lap: ring is full
+        return false;
+      } else {
+        pos = enqueue_pos.load(std::memory_order_relaxed);
+      }
+    }
+    target->data = std::move(new_value);
+    target->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t pop_ring(std::vector<T> &out, size_t max_count) {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      // count how many consecutive cells from pos are filled
+      size_t count = 0;
+      while (count < max_count) {
+        size_t seq = buffer[(pos + count) & mask].sequence.load(
+            std::memory_order_acquire);
+        if (seq != pos + count + 1) {
+          break;
+        }
+        count++;
+      }
+      if (count == 0) {
+        size_t seq =
+            buffer[pos & mask].sequence.load(std::memory_order_acquire);
+        intptr_t diff =
+            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff < 0) {
+          // nothing published at the head yet
+          return 0;
+        }
+        // another consumer went past pos
+        pos = dequeue_pos.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (dequeue_pos.compare_exchange_weak(pos, pos + count,
+                                            std::memory_order_relaxed)) {
+        for (size_t i = 0; i < count; i++) {
+          cell &source = buffer[(pos + i) & mask];
+          out.push_back(std::move(source.data));
+          // hand the cell over to the producers of the next lap
+          source.sequence.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return count;
+      }
+    }
+  }
+
+ public:
+  /* the ring holds 2^capacity_log2 tasks before spilling into overflow */
+  explicit inject_queue(int capacity_log2 = 14)
+      : mask((size_t(1) << capacity_log2) - 1),
+        buffer(new cell[mask + 1]) {
+    for (size_t i = 0; i <= mask; i++) {
+      buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  inject_queue(const inject_queue &other) = delete;
+  inject_queue &operator=(const inject_queue &other) = delete;
+
+  void push(T new_value) {
+    if (try_push_ring(new_value)) {
+      return;
+    }
+    std::lock_guard<std::mutex> overflow_lock(overflow_mutex);
+    overflow.push_back(std::move(new_value));
+    overflow_size.fetch_add(1, std::memory_order_release);
+  }
+
+  /*
+   * Append up to max_count items to out
+   * @return how many items have been appended
+   */
+  size_t pop_bulk(std::vector<T> &out, size_t max_count) {
+    size_t count = 0;
+    if (overflow_size.load(std::memory_order_acquire) > 0) {
+      // serve the spilled items first so that they cannot starve
+      std::lock_guard<std::mutex> overflow_lock(overflow_mutex);
+      while (count < max_count && !overflow.empty()) {
+        out.push_back(std::move(overflow.front()));
+        overflow.pop_front();
+        count++;
+      }
+      overflow_size.fetch_sub(count, std::memory_order_release);
+    }
+    if (count < max_count) {
+      count += pop_ring(out, max_count - count);
+    }
+    return count;
+  }
+  /* drop every queued item, @return how many were dropped */
+  size_t clear() {
+    std::vector<T> dropped;
+    size_t count = 0;
+    while (size_t n = pop_bulk(dropped, 64)) {
+      count += n;
+      dropped.clear();
+    }
+    return count;
+  }
+};
@@ -10,10 +10,11 @@
 
 #include "local_coarse_pool.h"
 
+#include <cinttypes>
 #include <iostream>
 
 LocalCoarsePool::LocalCoarsePool(int concurrency, PoolType pool_type)
-    : BasePool(concurrency, pool_type) {
+    : BasePool(concurrency, pool_type), placement_(concurrency) {
   for (int i = 0; i < concurrency_; i++) {
     // create padded resources
     auto r = std::make_unique<PaddedResource>();
@@ -23,9 +24,9 @@ LocalCoarsePool::LocalCoarsePool(int concurrency, PoolType pool_type)
     // create padded resources
     // create thread worker
     threads_.emplace_back([this, id = i] {
+      BindWorker(id);
       // in BATCH mode, wait for signal
-      while (status_ == PoolStatus::PREPARE) {
-      };
+      WaitForBegin();
       // enter main loop of polling and execution
       while (true) {
         Task next_task;
@@ -33,21 +34,24 @@ LocalCoarsePool::LocalCoarsePool(int concurrency, PoolType pool_type)
           // wait for either a task available, or exit signal
           std::unique_lock<std::mutex> lock(resources_[id]->mtx);
           resources_[id]->cv.wait(lock, [this, id]() -> bool {
-            return status_ == PoolStatus::EXIT ||
+            return GetStatus() != PoolStatus::RUNNING ||
                    !resources_[id]->queue.empty();
           });
-          if (resources_[id]->queue.empty() && status_ == PoolStatus::EXIT) {
+          if (GetStatus() == PoolStatus::SHUTDOWN ||
+              (resources_[id]->queue.empty() &&
+               GetStatus() == PoolStatus::EXIT)) {
             // this pool is about to be destroyed
             return;
           }
           next_task = resources_[id]->queue.front();
           resources_[id]->queue.pop();
         }
-        next_task();
-        // there is no add_fetch available
-        int post_increment = finish_count_.fetch_add(1) + 1;
-        if (post_increment == submit_count_) {
+        RunTask(next_task);
+        placement_.Finished(id);
+        if (CountFinish()) {
           // notify the WaitUntilFinished() caller
+          // under its mutex so that the wakeup cannot slip in before it waits
+          std::unique_lock<std::mutex> lock(mtx_count_);
           cv_count_.notify_all();
         }
       }
@@ -56,17 +60,31 @@ LocalCoarsePool::LocalCoarsePool(int concurrency, PoolType pool_type)
 }
 
 LocalCoarsePool::~LocalCoarsePool() {
+  Join();
+}
+
+void LocalCoarsePool::JoinWorkers() {
   // harvest all worker threads
   for (auto& worker : threads_) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  for (auto& resource : resources_) {
+    std::unique_lock<std::mutex> lock(resource->mtx);
+    cancelled_count_.fetch_add(resource->queue.size(),
+                               std::memory_order_relaxed);
+    resource->queue = {};
   }
 }
 
 void LocalCoarsePool::Submit(Task task) {
-  assert(status_ != PoolStatus::EXIT);
-  // Round-robin load balancer
-  int robin = submit_count_.fetch_add(1);  // atmoic add
-  int i = robin % concurrency_;
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // the less loaded of two random workers
+  CountSubmit();
+  int i = placement_.Place();
   {
     // does this create contention? but seems unavoidable
     std::unique_lock<std::mutex> lock(resources_[i]->mtx);
@@ -75,20 +93,41 @@ void LocalCoarsePool::Submit(Task task) {
   resources_[i]->cv.notify_all();
 }
 
+void LocalCoarsePool::Submit(uint64_t key, Task task,
+                             [[maybe_unused]] bool ordered) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // a worker runs its own queue in FIFO order, which already keeps a key
+  // serial, so ordered needs nothing extra here
+  CountSubmit();
+  int i = KeyToWorker(key);
+  placement_.Placed(i);
+  {
+    std::unique_lock<std::mutex> lock(resources_[i]->mtx);
+    resources_[i]->queue.push(std::move(task));
+  }
+  resources_[i]->cv.notify_all();
+}
+
 void LocalCoarsePool::WaitUntilFinished() {
   std::unique_lock<std::mutex> lock(mtx_count_);
-  cv_count_.wait(lock,
-                 [this]() -> bool { return submit_count_ == finish_count_; });
-  finish_count_.store(0);
-  submit_count_.store(0);
-  printf("task count: %d\n", finish_count_.load());
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
+  printf("task count: %" PRIu64 "\n",
+         finish_count_.load(std::memory_order_relaxed));
   fflush(stdout);
 }
 
-void LocalCoarsePool::Exit() {
-  status_ = PoolStatus::EXIT;
+void LocalCoarsePool::WakeWorkers() {
   for (int i = 0; i < concurrency_; i++) {
+    {
+      // pass through the mutex so no worker is between predicate and sleep
+      std::unique_lock<std::mutex> lock(resources_[i]->mtx);
+    }
     // wake up sleeping worker
     resources_[i]->cv.notify_all();
   }
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
 }
\ No newline at end of file
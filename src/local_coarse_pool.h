@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "base_pool.h"
+#include "placement.h"
 
 /* padded this struct to be at least multiples of cache-line width to avoid
  * false-sharing */
@@ -33,15 +34,21 @@ class LocalCoarsePool final : public BasePool {
 
   ~LocalCoarsePool();
 
+  /* keeps the cancellable Submit(task, token) visible */
+  using BasePool::Submit;
+
   void Submit(Task task) override;
 
-  void WaitUntilFinished() override;
+  void Submit(uint64_t key, Task task, bool ordered = false) override;
 
-  void Exit();
+  void WaitUntilFinished() override;
 
  private:
-  std::atomic<int> submit_count_{0};
-  std::atomic<int> finish_count_{0};
+  void WakeWorkers() override;
+  void JoinWorkers() override;
+
+  /* where Submit() puts a task, see placement.h */
+  Placement placement_;
   std::vector<std::thread> threads_;
   std::vector<std::unique_ptr<PaddedResource>> resources_;
   std::mutex mtx_count_;
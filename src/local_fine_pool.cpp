@@ -10,10 +10,11 @@
 
 #include "local_fine_pool.h"
 
+#include <cinttypes>
 #include <iostream>
 
 LocalFinePool::LocalFinePool(int concurrency, PoolType pool_type)
-    : BasePool(concurrency, pool_type) {
+    : BasePool(concurrency, pool_type), placement_(concurrency) {
   for (int i = 0; i < concurrency_; i++) {
     // create padded resources
     auto r = std::make_unique<PaddedResourceFine>();
@@ -23,36 +24,54 @@ LocalFinePool::LocalFinePool(int concurrency, PoolType pool_type)
     // create padded resources
     // create thread worker
     threads_.emplace_back([this, id = i] {
+      BindWorker(id);
+      // taken off the queue with one lock round trip, run from here in order
+      std::vector<Task> batch;
+      size_t batch_next = 0;
       // in BATCH mode, wait for signal
-      while (status_ == PoolStatus::PREPARE) {
-      };
+      WaitForBegin();
       // enter main loop of polling and execution
       while (true) {
+        if (GetStatus() == PoolStatus::SHUTDOWN) {
+          // queued tasks are abandoned, JoinWorkers() counts the rest
+          cancelled_count_.fetch_add(batch.size() - batch_next,
+                                     std::memory_order_relaxed);
+          return;
+        }
         Task next_task;
         bool has_next_task = false;
         {
           // wait for either a task available, or exit signal
           do {
-            has_next_task = resources_[id]->queue.pop(next_task);
+            if (batch_next == batch.size()) {
+              batch.clear();
+              batch_next = 0;
+              resources_[id]->queue.pop_bulk(batch, POP_BATCH_SIZE);
+            }
+            has_next_task = batch_next < batch.size();
+            if (has_next_task) {
+              next_task = std::move(batch[batch_next++]);
+            }
 
             if (!has_next_task) {
-              if (submit_count_ == finish_count_) {
+              if (AllFinished()) {
                 cv_count_.notify_all();
               }
               std::this_thread::yield();
             }
-          } while (!has_next_task && status_ != PoolStatus::EXIT);
+          } while (!has_next_task && GetStatus() == PoolStatus::RUNNING);
 
-          if (!has_next_task && status_ == PoolStatus::EXIT) {
+          if (!has_next_task) {
             // this pool is about to be destroyed
             return;
           }
         }
-        next_task();
-        // there is no add_fetch available
-        int post_increment = finish_count_.fetch_add(1) + 1;
-        if (post_increment == submit_count_.load()) {
+        RunTask(next_task);
+        placement_.Finished(id);
+        if (CountFinish()) {
           // notify the WaitUntilFinished() caller
+          // under its mutex so that the wakeup cannot slip in before it waits
+          std::unique_lock<std::mutex> lock(mtx_count_);
           cv_count_.notify_all();
         }
       }
@@ -61,17 +80,29 @@ LocalFinePool::LocalFinePool(int concurrency, PoolType pool_type)
 }
 
 LocalFinePool::~LocalFinePool() {
+  Join();
+}
+
+void LocalFinePool::JoinWorkers() {
   // harvest all worker threads
   for (auto& worker : threads_) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  for (auto& resource : resources_) {
+    cancelled_count_.fetch_add(resource->queue.clear() + resource->pinned.clear(),
+                               std::memory_order_relaxed);
   }
 }
 
 void LocalFinePool::Submit(Task task) {
-  assert(status_ != PoolStatus::EXIT);
-  // Round-robin load balancer
-  int robin = submit_count_.fetch_add(1);  // atmoic add
-  int i = robin % concurrency_;
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // the less loaded of two random workers
+  CountSubmit();
+  int i = placement_.Place();
   {
     // does this create contention? but seems unavoidable
     resources_[i]->queue.push(std::move(task));
@@ -79,21 +110,31 @@ void LocalFinePool::Submit(Task task) {
   resources_[i]->cv.notify_all();
 }
 
+void LocalFinePool::Submit(uint64_t key, Task task,
+                           [[maybe_unused]] bool ordered) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // a worker runs its own queue in FIFO order, which already keeps a key
+  // serial, so ordered needs nothing extra here
+  CountSubmit();
+  int i = KeyToWorker(key);
+  placement_.Placed(i);
+  resources_[i]->queue.push(std::move(task));
+  resources_[i]->cv.notify_all();
+}
+
 void LocalFinePool::WaitUntilFinished() {
   std::unique_lock<std::mutex> lock(mtx_count_);
   cv_count_.wait(lock, [this]() -> bool {
-    return submit_count_.load() == finish_count_.load();
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
   });
-  printf("task count: %d\n", finish_count_.load());
+  printf("task count: %" PRIu64 "\n",
+         finish_count_.load(std::memory_order_relaxed));
   fflush(stdout);
-  finish_count_.store(0);
-  submit_count_.store(0);
 }
 
-void LocalFinePool::Exit() {
-  status_ = PoolStatus::EXIT;
-  for (int i = 0; i < concurrency_; i++) {
-    // wake up sleeping worker
-    resources_[i]->cv.notify_all();
-  }
+void LocalFinePool::WakeWorkers() {
+  // workers poll their queue and the status, only the waiter sleeps
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
 }
\ No newline at end of file
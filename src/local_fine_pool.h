@@ -19,6 +19,7 @@
 
 #include "base_pool.h"
 #include "fine_queue.h"
+#include "placement.h"
 
 class LocalFinePool final : public BasePool {
  public:
@@ -26,15 +27,21 @@ class LocalFinePool final : public BasePool {
 
   ~LocalFinePool();
 
+  /* keeps the cancellable Submit(task, token) visible */
+  using BasePool::Submit;
+
   void Submit(Task task) override;
 
-  void WaitUntilFinished() override;
+  void Submit(uint64_t key, Task task, bool ordered = false) override;
 
-  void Exit();
+  void WaitUntilFinished() override;
 
  private:
-  std::atomic<int> submit_count_{0};
-  std::atomic<int> finish_count_{0};
+  void WakeWorkers() override;
+  void JoinWorkers() override;
+
+  /* where Submit() puts a task, see placement.h */
+  Placement placement_;
   std::vector<std::thread> threads_;
   std::vector<std::unique_ptr<PaddedResourceFine>> resources_;
   std::mutex mtx_count_;
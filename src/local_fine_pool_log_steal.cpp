@@ -14,31 +14,49 @@
 
 LocalFinePoolLogSteal::LocalFinePoolLogSteal(int concurrency,
                                              PoolType pool_type)
-    : BasePool(concurrency, pool_type) {
+    : BasePool(concurrency, pool_type), placement_(concurrency) {
   for (int i = 0; i < concurrency_; i++) {
     // create padded resources
     auto r = std::make_unique<PaddedResourceFine>();
     resources_.push_back(std::move(r));
+  }
+  // only start the workers once resources_ stops growing, they index it
+  for (int i = 0; i < concurrency_; i++) {
     // create thread worker
     threads_.emplace_back([this, id = i] {
+      BindWorker(id);
+      // taken off the queue with one lock round trip, run from here in order
+      std::vector<Task> batch;
+      size_t batch_next = 0;
       // in BATCH mode, wait for signal
-      while (status_ == PoolStatus::PREPARE) {
-      };
+      WaitForBegin();
       // enter main loop of polling and execution
       while (true) {
+        if (GetStatus() == PoolStatus::SHUTDOWN) {
+          // queued tasks are abandoned, JoinWorkers() counts the rest
+          cancelled_count_.fetch_add(batch.size() - batch_next,
+                                     std::memory_order_relaxed);
+          return;
+        }
         Task next_task;
         bool has_next_task = false;
         {
           // wait for either a task available, or exit signal
           do {
-            {
+            if (batch_next == batch.size()) {
+              batch.clear();
+              batch_next = 0;
               std::unique_lock<std::mutex> lock(resources_[id]->pop_mtx);
-              has_next_task = resources_[id]->queue.pop(next_task);
+              resources_[id]->queue.pop_bulk(batch, POP_BATCH_SIZE);
+            }
+            has_next_task = batch_next < batch.size();
+            if (has_next_task) {
+              next_task = std::move(batch[batch_next++]);
             }
             if (!has_next_task) {
               std::this_thread::yield();
             }
-          } while (!has_next_task && status_ != PoolStatus::EXIT);
+          } while (!has_next_task && GetStatus() == PoolStatus::RUNNING);
 
           //          std::unique_lock<std::mutex>
           //          lock(resources_[id]->pop_mtx);
@@ -47,18 +65,19 @@ LocalFinePoolLogSteal::LocalFinePoolLogSteal(int concurrency,
           //            has_next_task = resources_[id]->queue.pop(next_task);
           //            return status_ == PoolStatus::EXIT || has_next_task;
           //          });
-          if (!has_next_task && status_ == PoolStatus::EXIT) {
+          if (!has_next_task) {
             // this pool is about to be destroyed
             return;
           }
         }
-        next_task();
-        // there is no add_fetch available
-        int post_increment = finish_count_.fetch_add(1) + 1;
+        RunTask(next_task);
+        placement_.Finished(id);
         // printf("Finished task %d\n", post_increment);
         // fflush(stdout);
-        if (post_increment == submit_count_) {
+        if (CountFinish()) {
           // notify the WaitUntilFinished() caller
+          // under its mutex so that the wakeup cannot slip in before it waits
+          std::unique_lock<std::mutex> lock(mtx_count_);
           cv_count_.notify_all();
         }
       }
@@ -68,40 +87,56 @@ LocalFinePoolLogSteal::LocalFinePoolLogSteal(int concurrency,
 
 LocalFinePoolLogSteal::~LocalFinePoolLogSteal() {
   // force signal and clear
-  Exit();
+  Join();
+}
+
+void LocalFinePoolLogSteal::JoinWorkers() {
   // harvest all worker threads
   for (auto& worker : threads_) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  for (auto& resource : resources_) {
+    cancelled_count_.fetch_add(resource->queue.clear() + resource->pinned.clear(),
+                               std::memory_order_relaxed);
   }
 }
 
 void LocalFinePoolLogSteal::Submit(Task task) {
-  assert(status_ != PoolStatus::EXIT);
-  // Round-robin load balancer
-  int robin = submit_count_.fetch_add(1);  // atmoic add
-  int i = robin % concurrency_;
-  {
-    // does this create contention? but seems unavoidable
-    std::unique_lock<std::mutex> lock(resources_[i]->push_mtx);
-    resources_[i]->queue.push(std::move(task));
-    // printf("Pushed task %d\n", robin);
-    // fflush(stdout);
-  }
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // the less loaded of two random workers
+  CountSubmit();
+  int i = placement_.Place();
+  // fine_queue::push() takes the tail lock itself
+  resources_[i]->queue.push(std::move(task));
+  resources_[i]->cv.notify_all();
+}
+
+void LocalFinePoolLogSteal::Submit(uint64_t key, Task task,
+                                   [[maybe_unused]] bool ordered) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  // a worker runs its own queue in FIFO order, which already keeps a key
+  // serial, so ordered needs nothing extra here
+  CountSubmit();
+  int i = KeyToWorker(key);
+  placement_.Placed(i);
+  resources_[i]->queue.push(std::move(task));
   resources_[i]->cv.notify_all();
 }
 
 void LocalFinePoolLogSteal::WaitUntilFinished() {
   std::unique_lock<std::mutex> lock(mtx_count_);
-  cv_count_.wait(lock,
-                 [this]() -> bool { return submit_count_ == finish_count_; });
-  finish_count_.store(0);
-  submit_count_.store(0);
+  cv_count_.wait(lock, [this]() -> bool {
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
+  });
 }
 
-void LocalFinePoolLogSteal::Exit() {
-  status_ = PoolStatus::EXIT;
-  for (int i = 0; i < concurrency_; i++) {
-    // wake up sleeping worker
-    resources_[i]->cv.notify_all();
-  }
+void LocalFinePoolLogSteal::WakeWorkers() {
+  // workers poll their queue and the status, only the waiter sleeps
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
 }
\ No newline at end of file
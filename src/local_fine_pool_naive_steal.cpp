@@ -10,9 +10,12 @@
 
 #include "local_fine_pool_naive_steal.h"
 
+#include <cinttypes>
+
 LocalFinePoolNaiveSteal::LocalFinePoolNaiveSteal(int concurrency,
-                                                 PoolType pool_type)
-    : BasePool(concurrency, pool_type) {
+                                                 PoolType pool_type,
+                                                 StealOrder order)
+    : BasePool(concurrency, pool_type), order_(order) {
   for (int i = 0; i < concurrency_; i++) {
     // create padded resources
     auto r = std::make_unique<PaddedResourceFine>();
@@ -21,17 +24,53 @@ LocalFinePoolNaiveSteal::LocalFinePoolNaiveSteal(int concurrency,
   for (int i = 0; i < concurrency_; i++) {
     // create thread worker
     threads_.emplace_back([this, id = i] {
+      BindWorker(id);
+      std::vector<Task> batch;
+      // FIFO only: a few tasks of the own queue, out of the thieves' sight
+      std::vector<Task> own;
+      size_t own_next = 0;
       // in BATCH mode, wait for signal
-      while (status_ == PoolStatus::PREPARE) {
-      };
+      WaitForBegin();
       // enter main loop of polling and execution
       while (true) {
+        if (GetStatus() == PoolStatus::SHUTDOWN) {
+          // queued tasks are abandoned, JoinWorkers() counts the rest
+          cancelled_count_.fetch_add(own.size() - own_next,
+                                     std::memory_order_relaxed);
+          return;
+        }
         Task next_task;
         bool has_next_task = false;
         {
           // wait for either a task available, or exit signal
           do {
-            { has_next_task = resources_[id]->queue.pop(next_task); }
+            has_next_task = resources_[id]->pinned.pop(next_task);
+            if (has_next_task) {
+              break;
+            }
+            if (order_ == StealOrder::LIFO) {
+              has_next_task = resources_[id]->queue.pop_back(next_task);
+            } else {
+              if (own_next == own.size()) {
+                own.clear();
+                own_next = 0;
+                resources_[id]->queue.pop_bulk(own, POP_BATCH_SIZE);
+              }
+              has_next_task = own_next < own.size();
+              if (has_next_task) {
+                next_task = std::move(own[own_next++]);
+              }
+            }
+            if (!has_next_task &&
+                inject_queue_.pop_bulk(batch, INJECT_BATCH_SIZE) > 0) {
+              // run the first one, the rest is put where thieves can see it
+              next_task = std::move(batch[0]);
+              has_next_task = true;
+              for (size_t k = 1; k < batch.size(); k++) {
+                resources_[id]->queue.push(std::move(batch[k]));
+              }
+              batch.clear();
+            }
             if (!has_next_task) {
               // steal here
               for (int j = 1; j < concurrency_; j++) {
@@ -42,24 +81,24 @@ LocalFinePoolNaiveSteal::LocalFinePoolNaiveSteal(int concurrency,
                 }
               }
               if (!has_next_task) {
-                if (submit_count_ == finish_count_) {
+                if (AllFinished()) {
                   cv_count_.notify_all();
                 }
                 std::this_thread::yield();
               }
             }
-          } while (!has_next_task && status_ != PoolStatus::EXIT);
+          } while (!has_next_task && GetStatus() == PoolStatus::RUNNING);
 
-          if (!has_next_task && status_ == PoolStatus::EXIT) {
+          if (!has_next_task) {
             // this pool is about to be destroyed
             return;
           }
         }
-        next_task();
-        // there is no add_fetch available
-        int post_increment = finish_count_.fetch_add(1) + 1;
-        if (post_increment == submit_count_.load()) {
+        RunTask(next_task);
+        if (CountFinish()) {
           // notify the WaitUntilFinished() caller
+          // under its mutex so that the wakeup cannot slip in before it waits
+          std::unique_lock<std::mutex> lock(mtx_count_);
           cv_count_.notify_all();
         }
       }
@@ -68,39 +107,63 @@ LocalFinePoolNaiveSteal::LocalFinePoolNaiveSteal(int concurrency,
 }
 
 LocalFinePoolNaiveSteal::~LocalFinePoolNaiveSteal() {
+  Join();
+}
+
+void LocalFinePoolNaiveSteal::JoinWorkers() {
   // harvest all worker threads
   for (auto& worker : threads_) {
-    worker.join();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  // tasks are only left after a Shutdown(), they are dropped, account for them
+  for (auto& resource : resources_) {
+    cancelled_count_.fetch_add(resource->queue.clear() + resource->pinned.clear(),
+                               std::memory_order_relaxed);
   }
+  cancelled_count_.fetch_add(inject_queue_.clear(), std::memory_order_relaxed);
 }
 
 void LocalFinePoolNaiveSteal::Submit(Task task) {
-  assert(status_ != PoolStatus::EXIT);
-  // Round-robin load balancer
-  int robin = submit_count_.fetch_add(1);  // atomic add
-  int i = robin % concurrency_;
-  {
-    // does this create contention? but seems unavoidable
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  int id = CurrentWorkerId();
+  if (id >= 0) {
+    // spawned from inside a task, keep it local and let idle workers steal
+    resources_[id]->queue.push(std::move(task));
+    return;
+  }
+  // external submitters go through the lock-free injection queue
+  inject_queue_.push(std::move(task));
+}
+
+void LocalFinePoolNaiveSteal::Submit(uint64_t key, Task task, bool ordered) {
+  assert(GetStatus() == PoolStatus::PREPARE ||
+         GetStatus() == PoolStatus::RUNNING);
+  CountSubmit();
+  int i = KeyToWorker(key);
+  if (ordered) {
+    // thieves never look at the pinned queue, so the key stays serial
+    resources_[i]->pinned.push(std::move(task));
+  } else {
     resources_[i]->queue.push(std::move(task));
   }
-  resources_[i]->cv.notify_all();
 }
 
 void LocalFinePoolNaiveSteal::WaitUntilFinished() {
   std::unique_lock<std::mutex> lock(mtx_count_);
   cv_count_.wait(lock, [this]() -> bool {
-    return submit_count_.load() == finish_count_.load();
+    return AllFinished() || GetStatus() == PoolStatus::SHUTDOWN;
   });
-  finish_count_.store(0);
-  submit_count_.store(0);
-  printf("task count: %d\n", finish_count_.load());
+  printf("task count: %" PRIu64 "\n",
+         finish_count_.load(std::memory_order_relaxed));
   fflush(stdout);
 }
 
-void LocalFinePoolNaiveSteal::Exit() {
-  status_ = PoolStatus::EXIT;
-  for (int i = 0; i < concurrency_; i++) {
-    // wake up sleeping worker
-    resources_[i]->cv.notify_all();
-  }
+void LocalFinePoolNaiveSteal::WakeWorkers() {
+  // workers poll their queue and the status, only the waiter sleeps
+  std::unique_lock<std::mutex> lock(mtx_count_);
+  cv_count_.notify_all();
 }
\ No newline at end of file
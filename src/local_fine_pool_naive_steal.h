@@ -19,24 +19,44 @@
 
 #include "base_pool.h"
 #include "fine_queue.h"
+#include "inject_queue.h"
+
+/* how many injected tasks a worker takes over at once */
+#define INJECT_BATCH_SIZE 8
+
+/*
+ * The order in which a worker runs the tasks of its own queue
+ * FIFO: the owner and the thieves both take the oldest task
+ * LIFO: the owner takes its newest task (depth-first, cache-hot)
+ * while thieves still take the oldest, usually largest-grain, task
+ */
+enum class StealOrder { FIFO, LIFO };
 
 class LocalFinePoolNaiveSteal final : public BasePool {
  public:
-  LocalFinePoolNaiveSteal(int concurrency, PoolType pool_type);
+  LocalFinePoolNaiveSteal(int concurrency, PoolType pool_type,
+                          StealOrder order = StealOrder::FIFO);
 
   ~LocalFinePoolNaiveSteal();
 
+  /* keeps the cancellable Submit(task, token) visible */
+  using BasePool::Submit;
+
   void Submit(Task task) override;
 
-  void WaitUntilFinished() override;
+  void Submit(uint64_t key, Task task, bool ordered = false) override;
 
-  void Exit();
+  void WaitUntilFinished() override;
 
  private:
-  std::atomic<int> submit_count_{0};
-  std::atomic<int> finish_count_{0};
+  void WakeWorkers() override;
+  void JoinWorkers() override;
+
+  StealOrder order_;
   std::vector<std::thread> threads_;
   std::vector<std::unique_ptr<PaddedResourceFine>> resources_;
+  /* tasks submitted from outside the pool, drained by workers in batches */
+  inject_queue<Task> inject_queue_;
   std::mutex mtx_count_;
   std::condition_variable cv_count_;
 };
\ No newline at end of file
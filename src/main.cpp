@@ -6,18 +6,39 @@
  *
  * This is the main program entry for performance benchmarking
  * run the program by './run_pool [extra parameters specification see below]'
+ * or the stress suite by './run_pool stress [rounds] [seed]'
+ * or the fine_queue lock benchmark by './run_pool locks'
+ * or the memory order benchmark by './run_pool orders', which on a weakly
+ * ordered host, or a cross build under e.g. qemu-aarch64, shows what the
+ * acquire/release bookkeeping saves over seq_cst
+ * or the shared-memory multi-process pool test by './run_pool shm'
+ * or the loopback cluster test by './run_pool cluster'
+ * or the trace record and replay test by './run_pool trace'
+ * or a recorded trace replayed on each pool by './run_pool replay <trace>'
+ * or the auto-tuned pool by './run_pool tune [file]', which calibrates once
+ * per machine and keeps the result in the file, see auto_tuner.h
+ * every test also reports its perf_event_open() counters where the kernel
+ * permits them, 'ZORRO_PERF=0 ./run_pool ...' leaves them out
  */
 
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <random>
 #include <thread>
 
+#include "auto_tuner.h"
+#include "cluster_pool.h"
 #include "dummy_pool.h"
+#include "elastic_pool.h"
+#include "fiber_pool.h"
 #include "global_pool.h"
 #include "local_coarse_pool.h"
 #include "local_fine_pool.h"
 #include "local_fine_pool_naive_steal.h"
+#include "policy_pool.h"
+#include "shm_pool.h"
+#include "stress_test.h"
 #include "test.h"
 #include "timer.h"
 
@@ -46,6 +67,56 @@ void print_formatted_vector(const std::vector<std::string>& vec,
 }
 
 int main(int argc, char* argv[]) {
+  if (argc > 3 && strcmp(argv[1], SHM_WORKER_ARG) == 0) {
+    // started by a ShmPool as one of its worker processes
+    return ShmPool::WorkerMain(argv[2], atoi(argv[3]));
+  }
+  if (argc > 1 && strcmp(argv[1], CLUSTER_NODE_ARG) == 0) {
+    // started by the cluster test as one of the other nodes
+    return ClusterPool::NodeMain(argc - 2, argv + 2);
+  }
+  if (argc > 1 && strcmp(argv[1], "stress") == 0) {
+    int rounds = argc > 2 ? atoi(argv[2]) : STRESS_ROUNDS;
+    uint64_t seed = argc > 3 ? std::stoull(argv[3]) : std::random_device()();
+    return StressTest::Run(rounds, seed) == 0 ? 0 : 1;
+  }
+  if (argc > 1 && strcmp(argv[1], "locks") == 0) {
+    Test::lock_test();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "orders") == 0) {
+    Test::memory_order_test();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "shm") == 0) {
+    Test::shm_pool_test();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "cluster") == 0) {
+    Test::cluster_test();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "trace") == 0) {
+    LocalFinePoolNaiveSteal pool(THREAD_COUNT, PoolType::STREAM);
+    Test::trace_test(pool);
+    return 0;
+  }
+  if (argc > 2 && strcmp(argv[1], "replay") == 0) {
+    Test::replay_test(argv[2]);
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "tune") == 0) {
+    Timer timer;
+    TuneResult tune = AutoTuner::Tune(argc > 2 ? argv[2] : AUTO_TUNE_FILE);
+    std::cout << "Auto-tune took " << timer.Elapsed() << " millis" << std::endl;
+    AutoTuner::Print(std::cout, tune);
+    auto pool = AutoTuner::MakePool(tune, PoolType::STREAM);
+    Test::recursion_test(*pool);
+    Test::parallel_sort_test(*pool);
+    Test::fib_storm_test(*pool);
+    Test::uts_test(*pool);
+    return 0;
+  }
   int ops = atoi(argv[1]);
   std::cout << MSG << std::endl;
   std::cout << "Benchmark: Thread Count = " << THREAD_COUNT << std::endl;
@@ -53,16 +124,34 @@ int main(int argc, char* argv[]) {
   // baseline with Dummy Pool of direct blocking execution
   std::vector<std::string> tests = {"T=" + std::to_string(THREAD_COUNT),
                                     "correctness",
+                                    "cancellation",
+                                    "exception",
                                     "light",
+                                    "multiProducer",
                                     "normal",
                                     "imbalanced",
                                     "recursion",
-                                    "recursionMerge"};
+                                    "recursionMerge",
+                                    "scan",
+                                    "filter",
+                                    "histogram",
+                                    "strand",
+                                    "parallelSort",
+                                    "uts",
+                                    "fibStorm",
+                                    "matmul",
+                                    "bfs",
+                                    "spin"};
   std::vector<std::string> dummy_performance{"Dummy Pool"};
   std::vector<std::string> global_performance{"Global Pool"};
   std::vector<std::string> local_coarse_performance{"Local Coarse Pool"};
   std::vector<std::string> local_fine_performance{"Local Fine Pool"};
   std::vector<std::string> naive_steal_performance{"Naive Steal"};
+  std::vector<std::string> elastic_performance{"Elastic Pool"};
+  std::vector<std::string> lifo_steal_performance{"Naive Steal LIFO"};
+  std::vector<std::string> fiber_performance{"Fiber Pool"};
+  std::vector<std::string> policy_performance{"Policy Pool"};
+  std::vector<std::string> cluster_performance{"Cluster Pool"};
 
   // Global Pool
   if (ops == 1) {
@@ -71,9 +160,19 @@ int main(int argc, char* argv[]) {
     global_performance.push_back(std::to_string(Test::correctness_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    global_performance.push_back(std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     global_performance.push_back(std::to_string(Test::light_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    global_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     global_performance.push_back(std::to_string(Test::normal_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -87,6 +186,37 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::recursion_test_merge(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    global_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    global_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     pool.Exit();
   }
 
@@ -98,9 +228,21 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::correctness_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_coarse_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(
+        std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     local_coarse_performance.push_back(std::to_string(Test::light_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_coarse_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     local_coarse_performance.push_back(std::to_string(Test::normal_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -116,6 +258,39 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::recursion_test_merge(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_coarse_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(
+        std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(
+        std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_coarse_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     pool.Exit();
   }
 
@@ -128,9 +303,21 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::correctness_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_fine_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(
+        std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     local_fine_performance.push_back(std::to_string(Test::light_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_fine_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     local_fine_performance.push_back(std::to_string(Test::normal_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -146,6 +333,39 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::recursion_test_merge(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    local_fine_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(
+        std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(
+        std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    local_fine_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     pool.Exit();
   }
 
@@ -157,9 +377,21 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::correctness_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    naive_steal_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(
+        std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     naive_steal_performance.push_back(std::to_string(Test::light_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    naive_steal_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     naive_steal_performance.push_back(std::to_string(Test::normal_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -175,6 +407,408 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::recursion_test_merge(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    naive_steal_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(
+        std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(
+        std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    naive_steal_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    pool.Exit();
+  }
+
+  // Elastic Pool
+  if (ops == 5) {
+    ElasticPool pool(1, THREAD_COUNT, PoolType::STREAM);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    elastic_performance.push_back(std::to_string(Test::correctness_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::light_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::normal_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::imbalanced_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::recursion_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(
+        std::to_string(Test::recursion_test_merge(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    elastic_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    std::cout << "Elastic Pool: " << pool.GetLiveCount()
+              << " workers alive after the idle period" << std::endl;
+
+    // not part of the table, the other pools do not compensate
+    Test::blocking_test(pool);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    pool.Exit();
+  }
+
+  // Naive Steal, owner runs its newest task first
+  if (ops == 6) {
+    LocalFinePoolNaiveSteal pool(THREAD_COUNT, PoolType::STREAM,
+                                 StealOrder::LIFO);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    lifo_steal_performance.push_back(
+        std::to_string(Test::correctness_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::light_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::normal_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::imbalanced_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::recursion_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::recursion_test_merge(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(
+        std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    lifo_steal_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    pool.Exit();
+  }
+
+  // Fiber Pool, every task on its own stack
+  if (ops == 7) {
+    FiberPool pool(FIBER_WORKER_COUNT, PoolType::STREAM);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    fiber_performance.push_back(std::to_string(Test::correctness_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::light_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::normal_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::imbalanced_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::recursion_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(
+        std::to_string(Test::recursion_test_merge(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    fiber_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    // not part of the table, the other pools would not suspend the tasks
+    Test::fiber_test(pool);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    pool.Exit();
+  }
+
+  // Policy Pool, NaiveSteal's design as compile-time policies
+  if (ops == 8) {
+    PoolAdapter<NaiveStealPolicyPool> pool(THREAD_COUNT, PoolType::STREAM);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    policy_performance.push_back(
+        std::to_string(Test::correctness_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::light_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::normal_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::imbalanced_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::recursion_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::recursion_test_merge(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    policy_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    // not part of the table, no std::function and no virtual call
+    Test::policy_test();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    pool.Exit();
+  }
+
+  // Cluster Pool, a single node: the closures of the workloads stay local
+  if (ops == 9) {
+    ClusterPool pool(THREAD_COUNT, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    cluster_performance.push_back(std::to_string(Test::correctness_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(
+        std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::light_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::normal_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::imbalanced_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::recursion_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(
+        std::to_string(Test::recursion_test_merge(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    cluster_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    // not part of the table, registered tasks stolen by two more nodes
+    Test::cluster_test();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     pool.Exit();
   }
 
@@ -186,9 +820,19 @@ int main(int argc, char* argv[]) {
     dummy_performance.push_back(std::to_string(Test::correctness_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    dummy_performance.push_back(std::to_string(Test::cancellation_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::exception_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     dummy_performance.push_back(std::to_string(Test::light_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    dummy_performance.push_back(
+        std::to_string(Test::multi_producer_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     dummy_performance.push_back(std::to_string(Test::normal_test(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
@@ -202,6 +846,37 @@ int main(int argc, char* argv[]) {
         std::to_string(Test::recursion_test_merge(pool)));
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 
+    dummy_performance.push_back(std::to_string(Test::scan_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::filter_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::histogram_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::strand_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(
+        std::to_string(Test::parallel_sort_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::uts_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::fib_storm_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::matmul_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::bfs_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
+    dummy_performance.push_back(std::to_string(Test::spin_test(pool)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+
     pool.Exit();
   }
 
@@ -212,5 +887,10 @@ int main(int argc, char* argv[]) {
   print_formatted_vector(local_coarse_performance, dummy_performance, true);
   print_formatted_vector(local_fine_performance, dummy_performance, true);
   print_formatted_vector(naive_steal_performance, dummy_performance, true);
+  print_formatted_vector(elastic_performance, dummy_performance, true);
+  print_formatted_vector(lifo_steal_performance, dummy_performance, true);
+  print_formatted_vector(fiber_performance, dummy_performance, true);
+  print_formatted_vector(policy_performance, dummy_performance, true);
+  print_formatted_vector(cluster_performance, dummy_performance, true);
   return 0;
 }
@@ -0,0 +1,66 @@
+/**
+ * @file mpsc_queue.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements an unbounded lock-free queue
+ * for many producers and a single consumer
+ */
+
+#pragma once
+
+#include <atomic>
+
+/*
+ * Producers swing head to their new node with one exchange and then link the
+ * previous node to it. The consumer walks from tail, which always points to
+ * the last consumed node acting as a stub, so push and pop never touch the
+ * same node except through the next link.
+ */
+template <typename T>
+class mpsc_queue {
+ private:
+  struct node {
+    std::atomic<node *> next{nullptr};
+    T data;
+  };
+  std::atomic<node *> head;
+  node *tail;
+
+ public:
+  mpsc_queue() : head(new node), tail(head.load()) {}
+  mpsc_queue(const mpsc_queue &other) = delete;
+  mpsc_queue &operator=(const mpsc_queue &other) = delete;
+  ~mpsc_queue() {
+    while (tail != nullptr) {
+      node *next = tail->next.load(std::memory_order_relaxed);
+      delete tail;
+      tail = next;
+    }
+  }
+
+  /* safe to call from any number of threads */
+  void push(T new_value) {
+    node *new_head = new node;
+    new_head->data = std::move(new_value);
+    // seq_cst rather than acq_rel: Strand orders this against its flag
+    node *prev = head.exchange(new_head, std::memory_order_seq_cst);
+    prev->next.store(new_head, std::memory_order_release);
+  }
+
+  /* consumer only, may miss a push that has not linked its node yet */
+  bool pop(T &value) {
+    node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    value = std::move(next->data);
+    delete tail;
+    tail = next;
+    return true;
+  }
+
+  /* consumer only, false as soon as a push has started */
+  bool empty() { return head.load(std::memory_order_seq_cst) == tail; }
+};
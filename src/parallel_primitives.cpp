@@ -0,0 +1,115 @@
+/**
+ * @file parallel_primitives.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the data parallel primitives
+ * as blocked two-pass algorithms over the pool workers
+ */
+
+#include "parallel_primitives.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "simd_kernels.h"
+#include "task_group.h"
+
+/* how many blocks a range of n elements is cut into on this pool */
+static size_t BlocksFor(BasePool& pool, size_t n) {
+  size_t by_grain =
+      std::max<size_t>(1, n / pool.GetGrain(PARALLEL_PRIMITIVE_GRAIN));
+  return std::min(by_grain, static_cast<size_t>(pool.GetConcurrency()) * 4);
+}
+
+/*
+ * Call body(b, lo, hi) for every block b covering [lo, hi)
+ * each block is a task, unless there is a single one or the caller is a
+ * worker of the pool itself
+ */
+static void ForEachBlock(
+    BasePool& pool, size_t n, size_t blocks,
+    const std::function<void(size_t, size_t, size_t)>& body) {
+  auto bound = [n, blocks](size_t b) -> size_t { return n * b / blocks; };
+  if (blocks == 1 || pool.CurrentWorkerId() >= 0) {
+    for (size_t b = 0; b < blocks; b++) {
+      body(b, bound(b), bound(b + 1));
+    }
+    return;
+  }
+  TaskGroup group(pool);
+  for (size_t b = 0; b < blocks; b++) {
+    group.Run([&body, b, lo = bound(b), hi = bound(b + 1)]() {
+      body(b, lo, hi);
+    });
+  }
+  group.Wait();
+}
+
+void ParallelScan(BasePool& pool, const int* in, int* out, size_t n) {
+  const SimdKernels& kernels = GetSimdKernels();
+  size_t blocks = BlocksFor(pool, n);
+  // pass 1: the total of every block
+  std::vector<int> carry(blocks);
+  ForEachBlock(pool, n, blocks, [&](size_t b, size_t lo, size_t hi) {
+    carry[b] = kernels.sum(in + lo, hi - lo);
+  });
+  // exclusive scan of the totals, unsigned so that overflow wraps
+  uint32_t running = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    uint32_t total = static_cast<uint32_t>(carry[b]);
+    carry[b] = static_cast<int>(running);
+    running += total;
+  }
+  // pass 2: scan every block from the total of the blocks before it
+  ForEachBlock(pool, n, blocks, [&](size_t b, size_t lo, size_t hi) {
+    kernels.scan(in + lo, out + lo, hi - lo, carry[b]);
+  });
+}
+
+auto ParallelFilter(BasePool& pool, const int* in, size_t n, int pivot,
+                    int* out) -> size_t {
+  const SimdKernels& kernels = GetSimdKernels();
+  size_t blocks = BlocksFor(pool, n);
+  // pass 1: how many elements every block keeps
+  std::vector<size_t> count(blocks);
+  ForEachBlock(pool, n, blocks, [&](size_t b, size_t lo, size_t hi) {
+    count[b] = kernels.count_greater(in + lo, hi - lo, pivot);
+  });
+  std::vector<size_t> offset(blocks);
+  size_t total = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    offset[b] = total;
+    total += count[b];
+  }
+  // pass 2: every block writes to its own disjoint range of out
+  ForEachBlock(pool, n, blocks, [&](size_t b, size_t lo, size_t hi) {
+    kernels.filter_greater(in + lo, hi - lo, pivot, out + offset[b], count[b]);
+  });
+  return total;
+}
+
+void ParallelHistogram(BasePool& pool, const int* in, size_t n, int shift,
+                       int bits, uint64_t* hist) {
+  assert(0 < bits && bits <= 16 && 0 <= shift && shift + bits <= 32);
+  const SimdKernels& kernels = GetSimdKernels();
+  size_t bins = size_t(1) << bits;
+  size_t blocks = BlocksFor(pool, n);
+  // pass 1: a private histogram per block, no shared counters
+  std::vector<uint64_t> local(blocks * bins);
+  ForEachBlock(pool, n, blocks, [&](size_t b, size_t lo, size_t hi) {
+    kernels.histogram(in + lo, hi - lo, shift, bits, &local[b * bins]);
+  });
+  // pass 2: reduce the private histograms, every block owns a range of bins
+  size_t bin_blocks = std::min(blocks, bins);
+  ForEachBlock(pool, bins, bin_blocks, [&](size_t, size_t lo, size_t hi) {
+    for (size_t b = 0; b < blocks; b++) {
+      const uint64_t* source = &local[b * bins];
+      for (size_t bin = lo; bin < hi; bin++) {
+        hist[bin] += source[bin];
+      }
+    }
+  });
+}
@@ -0,0 +1,52 @@
+/**
+ * @file parallel_primitives.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the data parallel primitives
+ * on top of any threadpool: ParallelScan, ParallelFilter and
+ * ParallelHistogram, all on arrays of int
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "base_pool.h"
+
+/* below this many elements a block is not worth a task, unless the pool
+ * has a grain of its own, see BasePool::SetGrain() */
+#define PARALLEL_PRIMITIVE_GRAIN 65536
+
+/*
+ * The three primitives share one scheme: the array is cut into blocks, a
+ * first pass reduces every block on its own, the per-block results are
+ * combined serially, and a second pass uses them as the starting point of
+ * every block. The per-block loops run in the SIMD kernels of simd_kernels.h.
+ *
+ * Like ParallelSort, they must not block a worker of the same pool: called
+ * from a worker, every block runs inline on the caller.
+ */
+
+/**
+ * Inclusive prefix sum of in[0..n) into out, wrapping on overflow
+ * in and out may be the same array
+ */
+void ParallelScan(BasePool& pool, const int* in, int* out, size_t n);
+
+/**
+ * Copy the elements of in[0..n) that are greater than pivot to out,
+ * in their original order
+ * @return how many elements have been copied
+ */
+auto ParallelFilter(BasePool& pool, const int* in, size_t n, int pivot,
+                    int* out) -> size_t;
+
+/**
+ * Count in[0..n) into 2^bits bins by the bits [shift, shift + bits) of
+ * every element, the counts are added to hist
+ */
+void ParallelHistogram(BasePool& pool, const int* in, size_t n, int shift,
+                       int bits, uint64_t* hist);
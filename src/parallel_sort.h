@@ -0,0 +1,187 @@
+/**
+ * @file parallel_sort.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the parallel sort algorithms
+ * on top of any threadpool: ParallelMerge and ParallelSort
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "base_pool.h"
+#include "task_group.h"
+
+/* below this many elements a piece of work is not worth a task, unless
+ * the pool has a grain of its own, see BasePool::SetGrain() */
+#define PARALLEL_SORT_GRAIN 16384
+
+namespace parallel_sort_detail {
+
+/*
+ * Merge path: how many of the first d merged elements come from A
+ * ties are taken from A first, which keeps the merge stable
+ */
+template <typename ItA, typename ItB, typename Compare>
+size_t CoRank(size_t d, ItA a, size_t n1, ItB b, size_t n2, Compare comp) {
+  size_t lo = d > n2 ? d - n2 : 0;
+  size_t hi = std::min(d, n1);
+  while (lo < hi) {
+    size_t i = lo + (hi - lo) / 2;
+    size_t j = d - i;
+    if (j > 0 && i < n1 && !comp(b[j - 1], a[i])) {
+      // a[i] belongs before b[j - 1], take more of A
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+/* like std::merge, but moves the elements out of the two inputs */
+template <typename ItA, typename ItB, typename OutIt, typename Compare>
+void MoveMerge(ItA a, ItA a_end, ItB b, ItB b_end, OutIt out, Compare comp) {
+  while (a != a_end && b != b_end) {
+    if (comp(*b, *a)) {
+      *out++ = std::move(*b++);
+    } else {
+      *out++ = std::move(*a++);
+    }
+  }
+  out = std::move(a, a_end, out);
+  std::move(b, b_end, out);
+}
+
+/*
+ * Cut the merge of A and B into parts of equal output size, one task each
+ * kMove selects whether the inputs are moved or copied into out
+ */
+template <bool kMove, typename ItA, typename ItB, typename OutIt,
+          typename Compare>
+void MergeInto(TaskGroup& group, ItA a, size_t n1, ItB b, size_t n2,
+               OutIt out, size_t parts, Compare comp) {
+  size_t n = n1 + n2;
+  size_t prev_d = 0;
+  size_t prev_i = 0;
+  for (size_t p = 1; p <= parts; p++) {
+    size_t d = n * p / parts;
+    size_t i = CoRank(d, a, n1, b, n2, comp);
+    group.Run([=]() {
+      if constexpr (kMove) {
+        MoveMerge(a + prev_i, a + i, b + (prev_d - prev_i), b + (d - i),
+                  out + prev_d, comp);
+      } else {
+        std::merge(a + prev_i, a + i, b + (prev_d - prev_i), b + (d - i),
+                   out + prev_d, comp);
+      }
+    });
+    prev_d = d;
+    prev_i = i;
+  }
+}
+
+/* how many tasks a range of n elements is worth on this pool */
+inline size_t PartsFor(BasePool& pool, size_t n) {
+  size_t by_grain =
+      std::max<size_t>(1, n / pool.GetGrain(PARALLEL_SORT_GRAIN));
+  return std::min(by_grain, static_cast<size_t>(pool.GetConcurrency()) * 4);
+}
+
+}  // namespace parallel_sort_detail
+
+/**
+ * Merge the sorted ranges [first1, last1) and [first2, last2) into out
+ * the output is cut along the merge path, so every worker merges an equal
+ * share no matter how the values are distributed between the two inputs
+ * called from a worker of the same pool, it degrades to std::merge
+ */
+template <typename ItA, typename ItB, typename OutIt,
+          typename Compare = std::less<>>
+void ParallelMerge(BasePool& pool, ItA first1, ItA last1, ItB first2,
+                   ItB last2, OutIt out, Compare comp = Compare()) {
+  if (pool.CurrentWorkerId() >= 0) {
+    // waiting on a TaskGroup from a worker could take the last free one
+    std::merge(first1, last1, first2, last2, out, comp);
+    return;
+  }
+  size_t n1 = last1 - first1;
+  size_t n2 = last2 - first2;
+  TaskGroup group(pool);
+  parallel_sort_detail::MergeInto<false>(
+      group, first1, n1, first2, n2, out,
+      parallel_sort_detail::PartsFor(pool, n1 + n2), comp);
+  group.Wait();
+}
+
+/**
+ * Sort [first, last) with the workers of pool
+ * every block is sorted in its own task, then the blocks are merged pairwise
+ * with ParallelMerge, bouncing between the input and one scratch buffer that
+ * is allocated once for the whole sort
+ * called from a worker of the same pool, it degrades to std::sort
+ */
+template <typename RandomIt, typename Compare = std::less<>>
+void ParallelSort(BasePool& pool, RandomIt first, RandomIt last,
+                  Compare comp = Compare()) {
+  using T = typename std::iterator_traits<RandomIt>::value_type;
+  size_t n = last - first;
+  if (n < 2 * pool.GetGrain(PARALLEL_SORT_GRAIN) ||
+      pool.CurrentWorkerId() >= 0) {
+    std::sort(first, last, comp);
+    return;
+  }
+  // a power of two block count makes every merge round pair up evenly
+  size_t blocks = 1;
+  while (blocks * 2 <= parallel_sort_detail::PartsFor(pool, n)) {
+    blocks *= 2;
+  }
+  auto bound = [n, blocks](size_t b) -> size_t { return n * b / blocks; };
+
+  TaskGroup group(pool);
+  for (size_t b = 0; b < blocks; b++) {
+    group.Run([=]() {
+      std::sort(first + bound(b), first + bound(b + 1), comp);
+    });
+  }
+  group.Wait();
+
+  std::vector<T> buffer(n);
+  bool in_buffer = false;
+  for (size_t width = 1; width < blocks; width *= 2) {
+    for (size_t b = 0; b < blocks; b += 2 * width) {
+      size_t lo = bound(b);
+      size_t mid = bound(b + width);
+      size_t hi = bound(b + 2 * width);
+      size_t parts = parallel_sort_detail::PartsFor(pool, hi - lo);
+      if (!in_buffer) {
+        parallel_sort_detail::MergeInto<true>(group, first + lo, mid - lo,
+                                              first + mid, hi - mid,
+                                              buffer.begin() + lo, parts, comp);
+      } else {
+        parallel_sort_detail::MergeInto<true>(
+            group, buffer.begin() + lo, mid - lo, buffer.begin() + mid,
+            hi - mid, first + lo, parts, comp);
+      }
+    }
+    group.Wait();
+    in_buffer = !in_buffer;
+  }
+  if (in_buffer) {
+    // an odd number of rounds left the result in the scratch buffer
+    for (size_t b = 0; b < blocks; b++) {
+      group.Run([&buffer, first, lo = bound(b), hi = bound(b + 1)]() {
+        std::move(buffer.begin() + lo, buffer.begin() + hi, first + lo);
+      });
+    }
+    group.Wait();
+  }
+}
@@ -0,0 +1,239 @@
+/**
+ * @file perf_counters.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the PerfCounters
+ * every event of every thread is a counter of its own, not a group, so one
+ * event the machine lacks (LLC misses in a VM, say) does not take the
+ * others down; the hardware counters are user space only, which
+ * perf_event_paranoid up to 2 permits on one's own threads, and all of them
+ * are scaled up when multiplexed
+ */
+
+#include "perf_counters.h"
+
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+struct EventSpec {
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+};
+
+const EventSpec kEvents[PERF_EVENT_COUNT] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"cpu-migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+};
+
+/*
+ * Once an event fails for a reason that holds for every thread, e.g. no
+ * such hardware or no permission, it is not tried again for the next ones
+ */
+std::atomic<bool> event_refused[PERF_EVENT_COUNT];
+
+auto Enabled() -> bool {
+  static const bool enabled = []() {
+    const char* setting = getenv("ZORRO_PERF");
+    return setting == nullptr || strcmp(setting, "0") != 0;
+  }();
+  return enabled;
+}
+
+auto Open(const EventSpec& spec, pid_t tid) -> int {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  // the software events happen in the kernel by definition
+  attr.exclude_kernel = spec.type == PERF_TYPE_HARDWARE ? 1 : 0;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+/* @return the count scaled up for the time it was multiplexed out */
+auto Read(int fd, uint64_t& value) -> bool {
+  uint64_t data[3];  // value, time enabled, time running
+  if (read(fd, data, sizeof(data)) != sizeof(data)) {
+    return false;
+  }
+  value = data[2] == 0 ? 0
+                       : static_cast<uint64_t>(static_cast<long double>(
+                                                   data[0]) *
+                                               data[1] / data[2]);
+  return true;
+}
+
+auto ListThreads() -> std::vector<pid_t> {
+  std::vector<pid_t> tids;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) {
+    return tids;
+  }
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      tids.push_back(static_cast<pid_t>(atoi(entry->d_name)));
+    }
+  }
+  closedir(dir);
+  return tids;
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  if (!Enabled()) {
+    return;
+  }
+  for (pid_t tid : ListThreads()) {
+    Thread thread{tid, {}};
+    bool any = false;
+    bool out_of_fds = false;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+      thread.fds[e] = -1;
+      if (out_of_fds || event_refused[e].load(std::memory_order_relaxed)) {
+        continue;
+      }
+      thread.fds[e] = Open(kEvents[e], tid);
+      if (thread.fds[e] >= 0) {
+        any = true;
+      } else if (errno == EMFILE || errno == ENFILE) {
+        out_of_fds = true;
+      } else if (errno != ESRCH) {
+        // ESRCH is just this thread having exited meanwhile
+        event_refused[e].store(true, std::memory_order_relaxed);
+      }
+    }
+    if (any) {
+      threads_.push_back(thread);
+    }
+    if (out_of_fds || !any) {
+      missed_++;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (auto& thread : threads_) {
+    for (int fd : thread.fds) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  }
+}
+
+void PerfCounters::Stop() {
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+  // all of them first, so the reading is not counted by the later ones
+  for (auto& thread : threads_) {
+    for (int fd : thread.fds) {
+      if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+  }
+  for (auto& thread : threads_) {
+    PerfSample sample;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+      sample.counted[e] =
+          thread.fds[e] >= 0 && Read(thread.fds[e], sample.values[e]);
+    }
+    samples_.push_back(sample);
+  }
+}
+
+auto PerfCounters::Total() -> PerfSample {
+  PerfSample total;
+  for (auto& sample : samples_) {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+      total.values[e] += sample.values[e];
+      total.counted[e] = total.counted[e] || sample.counted[e];
+    }
+  }
+  return total;
+}
+
+void PerfCounters::Report(std::ostream& out, const std::string& name) {
+  Stop();
+  PerfSample total = Total();
+  if (std::none_of(std::begin(total.counted), std::end(total.counted),
+                   [](bool counted) { return counted; })) {
+    return;
+  }
+  out << name << " counters:";
+  for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+    out << " " << kEvents[e].name << " ";
+    if (total.counted[e]) {
+      out << total.values[e];
+    } else {
+      out << "n/a";
+    }
+  }
+  if (total.Has(PerfEvent::CYCLES) && total.Has(PerfEvent::INSTRUCTIONS) &&
+      total.Get(PerfEvent::CYCLES) > 0) {
+    char ipc[16];
+    snprintf(ipc, sizeof(ipc), "%.2f",
+             static_cast<double>(total.Get(PerfEvent::INSTRUCTIONS)) /
+                 total.Get(PerfEvent::CYCLES));
+    out << " IPC " << ipc;
+  }
+  out << std::endl;
+
+  // how evenly the work and the disruptions spread over the workers
+  out << name << " per thread (" << samples_.size() << " threads";
+  if (missed_ > 0) {
+    out << ", " << missed_ << " not counted";
+  }
+  out << ") min/median/max:";
+  std::vector<uint64_t> values(samples_.size());
+  for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+    if (!total.counted[e]) {
+      continue;
+    }
+    for (size_t i = 0; i < samples_.size(); i++) {
+      values[i] = samples_[i].values[e];
+    }
+    std::sort(values.begin(), values.end());
+    out << " " << kEvents[e].name << " " << values.front() << "/"
+        << values[values.size() / 2] << "/" << values.back();
+  }
+  out << std::endl;
+}
+
+PerfTimer::PerfTimer(std::string name) : name_(std::move(name)) {
+  // opening a counter per thread takes a while, leave it out of the time
+  Reset();
+}
+
+PerfTimer::~PerfTimer() { counters_.Report(std::cout, name_); }
+
+auto PerfTimer::Elapsed() noexcept -> uint64_t {
+  uint64_t elapsed = Timer::Elapsed();
+  counters_.Stop();
+  return elapsed;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file perf_counters.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the perf_event_open() counters of
+ * the benchmark: cycles, instructions, LLC misses, context switches and CPU
+ * migrations, counted on every thread of the process, so a run reports the
+ * total and how the workers differ, and why one pool beats another
+ *
+ * an event the kernel or the machine does not permit is reported as n/a,
+ * and ZORRO_PERF=0 in the environment turns the counters off altogether
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+
+#define PERF_EVENT_COUNT 5
+
+/* in report order */
+enum class PerfEvent {
+  CYCLES,
+  INSTRUCTIONS,
+  LLC_MISSES,
+  CONTEXT_SWITCHES,
+  CPU_MIGRATIONS
+};
+
+/* the counts of one thread or of all of them, see PerfCounters */
+struct PerfSample {
+  uint64_t values[PERF_EVENT_COUNT] = {};
+  bool counted[PERF_EVENT_COUNT] = {};
+
+  auto Get(PerfEvent event) const -> uint64_t {
+    return values[static_cast<int>(event)];
+  }
+  auto Has(PerfEvent event) const -> bool {
+    return counted[static_cast<int>(event)];
+  }
+};
+
+class PerfCounters {
+ public:
+  /* start counting on every thread the process has right now */
+  PerfCounters();
+
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /* stop counting and read the counters, later calls do nothing */
+  void Stop();
+
+  /* summed over the threads, after Stop() */
+  auto Total() -> PerfSample;
+
+  /* one sample per thread, after Stop() */
+  auto PerThread() -> const std::vector<PerfSample>& { return samples_; }
+
+  /**
+   * Print the total and the min/median/max over the threads, prefixed
+   * with name; prints nothing when no event could be counted
+   */
+  void Report(std::ostream& out, const std::string& name);
+
+ private:
+  struct Thread {
+    pid_t tid;
+    int fds[PERF_EVENT_COUNT];
+  };
+
+  std::vector<Thread> threads_;
+  std::vector<PerfSample> samples_;
+  /* threads left out, e.g. when out of file descriptors */
+  int missed_ = 0;
+  bool stopped_ = false;
+};
+
+/**
+ * A Timer that also counts the events of the region it times: the counters
+ * start with it and stop at the first Elapsed(), and are reported when it
+ * goes out of scope, i.e. right after the line of the test that used it
+ */
+class PerfTimer : public Timer {
+ public:
+  explicit PerfTimer(std::string name);
+
+  ~PerfTimer();
+
+  /* hides Timer::Elapsed(), to stop the counters along */
+  auto Elapsed() noexcept -> uint64_t;
+
+ private:
+  std::string name_;
+  PerfCounters counters_;
+};
@@ -0,0 +1,78 @@
+/**
+ * @file placement.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the queue-aware submission placement
+ * of the pools with one queue per worker: every worker publishes its load,
+ * i.e. the tasks placed on it and not finished yet, and a submission goes
+ * to the less loaded of two random workers (power of two choices)
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+class Placement {
+ public:
+  explicit Placement(int concurrency)
+      : concurrency_(concurrency), loads_(new Load[concurrency]) {}
+
+  Placement(const Placement&) = delete;
+  Placement& operator=(const Placement&) = delete;
+
+  /**
+   * Choose the worker for a new task and count it on that worker
+   * an idle worker has no load, so it wins against any busy one
+   */
+  auto Place() -> int {
+    int chosen = 0;
+    if (concurrency_ > 1) {
+      uint64_t dice = NextRandom();
+      int a = static_cast<int>((dice & 0xffffffff) % concurrency_);
+      int b = static_cast<int>((dice >> 32) % (concurrency_ - 1));
+      // b is drawn from the others, so the two choices always differ
+      b += b >= a ? 1 : 0;
+      chosen = GetLoad(b) < GetLoad(a) ? b : a;
+    }
+    Placed(chosen);
+    return chosen;
+  }
+
+  /* count a task placed on worker id by other means, e.g. by its key */
+  void Placed(int id) {
+    loads_[id].count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* worker id has finished one of its tasks */
+  void Finished(int id) {
+    loads_[id].count.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /* approximate, the counts are only ever read as a hint */
+  auto GetLoad(int id) -> int64_t {
+    return loads_[id].count.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /* xorshift64*, one stream per submitting thread */
+  static auto NextRandom() -> uint64_t {
+    thread_local uint64_t state =
+        reinterpret_cast<uintptr_t>(&state) | 1;  // distinct per thread
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1dULL;
+  }
+
+  /* a worker and its submitters hammer its count, keep it on its own line */
+  struct alignas(64) Load {
+    std::atomic<int64_t> count{0};
+  };
+
+  int concurrency_;
+  std::unique_ptr<Load[]> loads_;
+};
@@ -0,0 +1,452 @@
+/**
+ * @file policy_pool.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the policy-based threadpool
+ * Pool<QueuePolicy, StealPolicy, IdlePolicy, StatsPolicy, T> is the worker
+ * loop that the hand-written pools share, with the parts they differ in
+ * picked at compile time, so that the policies inline into the loop and
+ * Submit() is not virtual. T is the task type: with a plain function
+ * pointer, not even a std::function is left on the hot path.
+ *
+ * PoolAdapter<P> puts a BasePool face on such a pool for the benchmark
+ * and for the code written against BasePool.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "base_pool.h"
+#include "fine_queue.h"
+
+/* --- QueuePolicy: where a submission goes and where a worker looks first */
+
+/* one locked queue that every worker pops from, as in GlobalPool */
+struct SharedQueue {
+  template <typename T>
+  class Queues {
+   public:
+    explicit Queues(int) {}
+
+    auto Count() -> int { return 1; }
+
+    void Push(int, uint64_t, T task) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      queue_.push(std::move(task));
+    }
+
+    auto Pop(int, T& task) -> bool { return PopFrom(0, task); }
+
+    auto PopFrom(int, T& task) -> bool {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (queue_.empty()) {
+        return false;
+      }
+      task = std::move(queue_.front());
+      queue_.pop();
+      return true;
+    }
+
+    auto Empty(int) -> bool {
+      std::lock_guard<std::mutex> lock(mtx_);
+      return queue_.empty();
+    }
+
+    /* drop everything queued, @return how many tasks were dropped */
+    auto Clear() -> size_t {
+      std::lock_guard<std::mutex> lock(mtx_);
+      size_t count = queue_.size();
+      queue_ = {};
+      return count;
+    }
+
+   private:
+    std::mutex mtx_;
+    std::queue<T> queue_;
+  };
+};
+
+/*
+ * A fine_queue per worker, as in LocalFinePool: external submissions are
+ * dealt out round robin, a task submitted by a worker stays on its queue
+ */
+struct LocalQueues {
+  template <typename T>
+  class Queues {
+   public:
+    explicit Queues(int concurrency) {
+      for (int i = 0; i < concurrency; i++) {
+        queues_.push_back(std::make_unique<Padded>());
+      }
+    }
+
+    auto Count() -> int { return static_cast<int>(queues_.size()); }
+
+    void Push(int submitter, uint64_t ticket, T task) {
+      int i = submitter >= 0 ? submitter
+                             : static_cast<int>(ticket % queues_.size());
+      queues_[i]->queue.push(std::move(task));
+    }
+
+    auto Pop(int id, T& task) -> bool { return PopFrom(id, task); }
+
+    auto PopFrom(int victim, T& task) -> bool {
+      return queues_[victim]->queue.pop(task);
+    }
+
+    auto Empty(int id) -> bool { return queues_[id]->queue.empty(); }
+
+    /* drop everything queued, @return how many tasks were dropped */
+    auto Clear() -> size_t {
+      size_t count = 0;
+      for (auto& padded : queues_) {
+        count += padded->queue.clear();
+      }
+      return count;
+    }
+
+   private:
+    /* padded to avoid false sharing between neighbouring queues */
+    struct alignas(256) Padded {
+      fine_queue<T> queue;
+    };
+    std::vector<std::unique_ptr<Padded>> queues_;
+  };
+};
+
+/* --- StealPolicy: where a worker looks once its own queue is empty */
+
+/* never, as in LocalFinePool */
+struct NoSteal {
+  /* a worker only reaches the tasks of its own queue */
+  static constexpr bool kReachesAll = false;
+
+  template <typename Q, typename T>
+  static auto Steal(Q&, int, T&) -> bool {
+    return false;
+  }
+
+  /* whether worker id could find something to run */
+  template <typename Q>
+  static auto Visible(Q& queues, int id) -> bool {
+    return !queues.Empty(queues.Count() == 1 ? 0 : id);
+  }
+};
+
+/* the other queues in turn, starting from the next one, as in NaiveSteal */
+struct RingSteal {
+  static constexpr bool kReachesAll = true;
+
+  template <typename Q, typename T>
+  static auto Steal(Q& queues, int id, T& task) -> bool {
+    int count = queues.Count();
+    for (int j = 1; j < count; j++) {
+      if (queues.PopFrom((id + j) % count, task)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename Q>
+  static auto Visible(Q& queues, int) -> bool {
+    for (int i = 0; i < queues.Count(); i++) {
+      if (!queues.Empty(i)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/* --- IdlePolicy: what a worker does when it found nothing to run */
+
+/* yield and poll again, as the local pools do; lowest latency, burns CPU */
+struct SpinIdle {
+  template <typename Ready>
+  void Idle(Ready&&) {
+    std::this_thread::yield();
+  }
+
+  void Notify(bool) {}
+
+  void WakeAll() {}
+};
+
+/*
+ * Sleep on a condition variable, as GlobalPool does
+ * a submission only touches the mutex while some worker actually sleeps
+ */
+class SleepIdle {
+ public:
+  template <typename Ready>
+  void Idle(Ready&& ready) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    // announce the sleep before checking, Notify() checks the other way round
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    cv_.wait(lock, ready);
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  /* @param any_worker whether every worker can run the new task */
+  void Notify(bool any_worker) {
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (any_worker) {
+        cv_.notify_one();
+      } else {
+        // only the owner of the queue can, and it may be any of the sleepers
+        cv_.notify_all();
+      }
+    }
+  }
+
+  void WakeAll() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::atomic<int> sleepers_{0};
+};
+
+/* --- StatsPolicy: what is recorded per worker */
+
+/* nothing, the calls compile away */
+struct NoStats {
+  explicit NoStats(int) {}
+  void OnRun(int) {}
+  void OnSteal(int) {}
+};
+
+/* how many tasks every worker has run and stolen */
+class CountingStats {
+ public:
+  explicit CountingStats(int concurrency) : slots_(concurrency) {}
+
+  void OnRun(int id) { slots_[id].runs++; }
+  void OnSteal(int id) { slots_[id].steals++; }
+
+  /* read after WaitUntilFinished(), which orders the workers' writes */
+  auto GetRuns(int id) -> uint64_t { return slots_[id].runs; }
+  auto GetSteals(int id) -> uint64_t { return slots_[id].steals; }
+
+ private:
+  /* every worker writes only its own slot */
+  struct alignas(64) Slot {
+    uint64_t runs{0};
+    uint64_t steals{0};
+  };
+  std::vector<Slot> slots_;
+};
+
+/* runs on every worker thread before its loop, see PoolAdapter */
+using WorkerHook = std::function<void(int)>;
+
+/*
+ * The status, the counters, the error path and the worker binding are
+ * BasePool's, from PoolCore; a failed task counts in GetFailedCount() and
+ * goes to the handler of SetErrorHandler(), as on any other pool
+ */
+template <typename QueuePolicy, typename StealPolicy, typename IdlePolicy,
+          typename StatsPolicy, typename T = Task>
+class Pool : public PoolCore<Pool<QueuePolicy, StealPolicy, IdlePolicy,
+                                  StatsPolicy, T>> {
+  using Core = PoolCore<Pool>;
+
+ public:
+  /**
+   * @param on_start called on every worker with its index before it runs
+   * anything, e.g. to bind it somewhere
+   * @param on_error installed with SetErrorHandler() before any worker starts
+   */
+  explicit Pool(int concurrency, WorkerHook on_start = nullptr,
+                ErrorHandler on_error = nullptr)
+      : Core(concurrency, PoolStatus::RUNNING),
+        queues_(concurrency),
+        stats_(concurrency),
+        on_start_(std::move(on_start)) {
+    if (on_error) {
+      this->SetErrorHandler(std::move(on_error));
+    }
+    for (int i = 0; i < concurrency; i++) {
+      threads_.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+  }
+
+  ~Pool() { Join(); }
+
+  auto GetStats() -> StatsPolicy& { return stats_; }
+
+  /* not virtual, the policies inline into the caller */
+  void Submit(T task) {
+    assert(this->GetStatus() == PoolStatus::RUNNING);
+    uint64_t ticket = this->CountSubmit();
+    queues_.Push(this->CurrentWorkerId(), ticket, std::move(task));
+    idle_.Notify(StealPolicy::kReachesAll || queues_.Count() == 1);
+  }
+
+  /* same contract as BasePool::WaitUntilFinished() */
+  void WaitUntilFinished() {
+    std::unique_lock<std::mutex> lock(mtx_count_);
+    cv_count_.wait(lock, [this]() -> bool {
+      return this->AllFinished() ||
+             this->GetStatus() == PoolStatus::SHUTDOWN;
+    });
+  }
+
+  /* the workers run what is queued, then leave */
+  void Exit() { SetStatus(PoolStatus::EXIT); }
+
+  /* the workers leave after their current task */
+  void Shutdown() { SetStatus(PoolStatus::SHUTDOWN); }
+
+  /* same contract as BasePool::Join(), the destructor calls it too */
+  void Join() {
+    Exit();
+    // harvest all worker threads
+    for (auto& worker : threads_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    // tasks are only left after a Shutdown(), they are dropped, account for them
+    this->cancelled_count_.fetch_add(queues_.Clear(),
+                                     std::memory_order_relaxed);
+  }
+
+ private:
+  /* PoolCore's, then wake the workers and the waiter to look at it */
+  void SetStatus(PoolStatus status) {
+    Core::SetStatus(status);
+    {
+      std::unique_lock<std::mutex> lock(mtx_count_);
+      cv_count_.notify_all();
+    }
+    idle_.WakeAll();
+  }
+
+  void WorkerLoop(int id) {
+    this->BindWorker(id);
+    if (on_start_) {
+      on_start_(id);
+    }
+    auto ready = [this, id]() -> bool {
+      return this->GetStatus() != PoolStatus::RUNNING ||
+             StealPolicy::Visible(queues_, id);
+    };
+    while (true) {
+      // read before looking: after EXIT, empty queues stay empty
+      PoolStatus status = this->GetStatus();
+      if (status == PoolStatus::SHUTDOWN) {
+        // queued tasks are abandoned
+        return;
+      }
+      T task;
+      if (queues_.Pop(id, task)) {
+        Run(id, task);
+      } else if (StealPolicy::Steal(queues_, id, task)) {
+        stats_.OnSteal(id);
+        Run(id, task);
+      } else if (status == PoolStatus::EXIT) {
+        return;
+      } else {
+        idle_.Idle(ready);
+      }
+    }
+  }
+
+  void Run(int id, T& task) {
+    this->RunTask(task);
+    stats_.OnRun(id);
+    if (this->CountFinish()) {
+      std::unique_lock<std::mutex> lock(mtx_count_);
+      cv_count_.notify_all();
+    }
+  }
+
+  typename QueuePolicy::template Queues<T> queues_;
+  IdlePolicy idle_;
+  StatsPolicy stats_;
+  WorkerHook on_start_;
+
+  std::mutex mtx_count_;
+  std::condition_variable cv_count_;
+
+  std::vector<std::thread> threads_;
+};
+
+/* the designs of the hand-written pools, expressed as policies */
+using GlobalPolicyPool = Pool<SharedQueue, NoSteal, SleepIdle, NoStats>;
+using LocalFinePolicyPool = Pool<LocalQueues, NoSteal, SpinIdle, NoStats>;
+using NaiveStealPolicyPool = Pool<LocalQueues, RingSteal, SpinIdle, NoStats>;
+
+/*
+ * BasePool on top of a policy pool of Task, for the benchmark table
+ * the virtual Submit() comes back, the policies stay inlined behind it
+ * keyed submission falls back to plain Submit
+ */
+template <typename P>
+class PoolAdapter final : public BasePool {
+ public:
+  PoolAdapter(int concurrency, PoolType pool_type)
+      : BasePool(concurrency, pool_type),
+        pool_(
+            concurrency,
+            [this](int id) {
+              BindWorker(id);
+              // in BATCH mode, wait for signal
+              WaitForBegin();
+            },
+            // counted by the adapter too, its GetFailedCount() is the one
+            // read through BasePool
+            [this](std::exception_ptr error) {
+              failed_count_.fetch_add(1, std::memory_order_relaxed);
+              ReportError(error);
+            }) {}
+
+  /* release workers still parked in WaitForBegin() before joining them */
+  ~PoolAdapter() { Join(); }
+
+  using BasePool::Submit;
+
+  void Submit(Task task) override { pool_.Submit(std::move(task)); }
+
+  void WaitUntilFinished() override { pool_.WaitUntilFinished(); }
+
+  auto GetPool() -> P& { return pool_; }
+
+ private:
+  void WakeWorkers() override {
+    if (GetStatus() == PoolStatus::SHUTDOWN) {
+      pool_.Shutdown();
+    } else if (GetStatus() == PoolStatus::EXIT) {
+      pool_.Exit();
+    }
+  }
+
+  /* the tasks pool_ drops are dropped through this pool as well */
+  void JoinWorkers() override {
+    uint64_t before = pool_.GetCancelledCount();
+    pool_.Join();
+    cancelled_count_.fetch_add(pool_.GetCancelledCount() - before,
+                               std::memory_order_relaxed);
+  }
+
+  P pool_;
+};
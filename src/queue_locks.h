@@ -0,0 +1,257 @@
+/**
+ * @file queue_locks.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the locks fine_queue can be
+ * instantiated with besides std::mutex, for queues that many producers
+ * push to at once: TicketLock, McsLock and CombiningLock
+ * all of them spin, and fall back to yielding once a wait gets long
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <type_traits>
+
+/* spins before a waiting thread starts to yield its time slice */
+#define LOCK_SPIN_LIMIT 128
+
+/* how many MCS locks one thread can hold at the same time, holding one
+ * more aborts */
+#define MCS_MAX_NESTING 4
+
+/* how many threads can have a request pending with one CombiningLock */
+#define COMBINING_SLOTS 64
+
+/* one step of a spin-wait, the counter tells when to give up the core */
+inline void SpinPause(int& spins) {
+  if (++spins < LOCK_SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+/*
+ * First come, first served: every waiter draws a ticket and spins until it
+ * is served, so no producer starves, but all of them spin on one line
+ */
+class TicketLock {
+ public:
+  void lock() {
+    uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+    int spins = 0;
+    while (serving_.load(std::memory_order_acquire) != ticket) {
+      SpinPause(spins);
+    }
+  }
+
+  auto try_lock() -> bool {
+    uint32_t serving = serving_.load(std::memory_order_relaxed);
+    uint32_t expected = serving;
+    return next_.compare_exchange_strong(expected, serving + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed);
+  }
+
+  void unlock() {
+    // only the holder writes serving_
+    serving_.store(serving_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+  }
+
+ private:
+  alignas(64) std::atomic<uint32_t> next_{0};
+  alignas(64) std::atomic<uint32_t> serving_{0};
+};
+
+/*
+ * Mellor-Crummey and Scott queue lock: FIFO like the ticket lock, but every
+ * waiter spins on a flag of its own, so a hand-over touches one other core
+ * the queue nodes are per thread, hence locks must be released in the
+ * reverse order of acquisition, as std::lock_guard scopes do
+ */
+class McsLock {
+ public:
+  void lock() {
+    if (tls_depth_ == MCS_MAX_NESTING) {
+      // past the end of tls_nodes_ it would corrupt the next thread_local
+      fprintf(stderr, "McsLock: more than %d held by one thread\n",
+              MCS_MAX_NESTING);
+      std::abort();
+    }
+    Node* me = &tls_nodes_[tls_depth_++];
+    me->next.store(nullptr, std::memory_order_relaxed);
+    me->locked.store(true, std::memory_order_relaxed);
+    Node* prev = tail_.exchange(me, std::memory_order_acq_rel);
+    if (prev != nullptr) {
+      prev->next.store(me, std::memory_order_release);
+      int spins = 0;
+      while (me->locked.load(std::memory_order_acquire)) {
+        SpinPause(spins);
+      }
+    }
+    holder_ = me;
+  }
+
+  void unlock() {
+    Node* me = holder_;
+    Node* next = me->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      Node* expected = me;
+      if (tail_.compare_exchange_strong(expected, nullptr,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+        tls_depth_--;
+        return;
+      }
+      // a successor is between its exchange and linking itself in
+      int spins = 0;
+      while ((next = me->next.load(std::memory_order_acquire)) == nullptr) {
+        SpinPause(spins);
+      }
+    }
+    next->locked.store(false, std::memory_order_release);
+    tls_depth_--;
+  }
+
+ private:
+  /* set up by lock() on every use */
+  struct alignas(64) Node {
+    std::atomic<Node*> next;
+    std::atomic<bool> locked;
+  };
+
+  alignas(64) std::atomic<Node*> tail_{nullptr};
+  Node* holder_{nullptr};  // only touched by the holder
+
+  inline static thread_local Node tls_nodes_[MCS_MAX_NESTING];
+  inline static thread_local int tls_depth_ = 0;
+};
+
+/*
+ * Flat combining: a thread that finds the lock taken publishes its critical
+ * section instead of queueing for the lock, and whoever holds the lock runs
+ * every published section in one go, while the lines are hot in its cache
+ * lock() is a plain test-and-test-and-set lock for the callers that need to
+ * hold it themselves, combine() is the combining path; whichever way the
+ * lock was taken, unlock() runs the sections published meanwhile first
+ */
+class CombiningLock {
+ public:
+  void lock() {
+    int spins = 0;
+    while (!try_lock()) {
+      SpinPause(spins);
+    }
+  }
+
+  auto try_lock() -> bool {
+    return !locked_.load(std::memory_order_relaxed) &&
+           !locked_.exchange(true, std::memory_order_acquire);
+  }
+
+  void unlock() {
+    // a section published after the check is run by its own thread, which
+    // keeps trying the lock until it is done
+    if (pending_.load(std::memory_order_acquire) > 0) {
+      CombineAll();
+    }
+    locked_.store(false, std::memory_order_release);
+  }
+
+  /* run section() under the lock, on this thread or on the combiner's */
+  template <typename F>
+  void combine(F&& section) {
+    if (try_lock()) {
+      section();
+      unlock();
+      return;
+    }
+    Request request{&Invoke<F>, &section};
+    std::atomic<Request*>* slot = Publish(&request);
+    if (slot == nullptr) {
+      // every slot is taken, queue for the lock after all
+      lock();
+      section();
+      unlock();
+      return;
+    }
+    int spins = 0;
+    while (!request.done.load(std::memory_order_acquire)) {
+      if (try_lock()) {
+        // unlock() runs ours too, unless someone else got to it first
+        unlock();
+        return;
+      }
+      SpinPause(spins);
+    }
+  }
+
+ private:
+  struct Request {
+    void (*invoke)(void*);
+    void* section;
+    std::atomic<bool> done{false};
+  };
+
+  template <typename F>
+  static void Invoke(void* section) {
+    (*static_cast<std::remove_reference_t<F>*>(section))();
+  }
+
+  /* @return the slot holding request, null if none was free */
+  auto Publish(Request* request) -> std::atomic<Request*>* {
+    // counted before it is visible, so pending_ never runs short
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    // start at a different slot on every thread to spread the probes
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (size_t i = 0; i < COMBINING_SLOTS; i++) {
+      std::atomic<Request*>& slot = slots_[(start + i) % COMBINING_SLOTS].ptr;
+      Request* expected = nullptr;
+      if (slot.load(std::memory_order_relaxed) == nullptr &&
+          slot.compare_exchange_strong(expected, request,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return &slot;
+      }
+    }
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  /* run every published section, the caller holds the lock */
+  void CombineAll() {
+    for (size_t i = 0; i < COMBINING_SLOTS; i++) {
+      std::atomic<Request*>& slot = slots_[i].ptr;
+      Request* request = slot.load(std::memory_order_acquire);
+      if (request == nullptr) {
+        continue;
+      }
+      request->invoke(request->section);
+      slot.store(nullptr, std::memory_order_relaxed);
+      pending_.fetch_sub(1, std::memory_order_relaxed);
+      // last touch: the owner may return and drop request right after
+      request->done.store(true, std::memory_order_release);
+    }
+  }
+
+  struct alignas(64) Slot {
+    std::atomic<Request*> ptr{nullptr};
+  };
+
+  alignas(64) std::atomic<bool> locked_{false};
+  /* sections published and not run yet, unlock() skips the scan at 0 */
+  std::atomic<int> pending_{0};
+  Slot slots_[COMBINING_SLOTS];
+};
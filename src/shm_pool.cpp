@@ -0,0 +1,486 @@
+/**
+ * @file shm_pool.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the ShmPool
+ *
+ * every queue is a ring of descriptors under a robust process-shared mutex,
+ * so a worker dying while holding it only makes the next locker mark it
+ * consistent: a pop copies the descriptor out and moves the head last, so
+ * the ring is never half updated, at worst a task is left queued after it
+ * has been taken, and runs twice
+ *
+ * a worker publishes what it runs in its Slot, and its done count and busy
+ * bit share one word, so finishing a task is a single store a crash cannot
+ * tear; sleeping uses bare futexes, which keep no state a crash could leave
+ * behind, unlike a process-shared condition variable
+ */
+
+#include "shm_pool.h"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include "base_pool.h"
+
+extern char** environ;
+
+namespace {
+
+/* tells a worker it attached to a region that is fully set up */
+constexpr uint32_t kRegionMagic = 0x5a4f5252;  // "ZORR"
+
+auto Align(size_t size) -> size_t { return (size + 63) & ~size_t(63); }
+
+void LockRobust(pthread_mutex_t* mutex) {
+  if (pthread_mutex_lock(mutex) == EOWNERDEAD) {
+    // the owner died, and the ring is consistent at every step
+    pthread_mutex_consistent(mutex);
+  }
+}
+
+/* sleep while word still holds expected, for millis at most */
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, int millis) {
+  struct timespec timeout = {0, millis * 1000000L};
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+          &timeout, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>* word, int count) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, count,
+          nullptr, nullptr, 0);
+}
+
+[[noreturn]] void ThrowErrno(const char* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+/* the atomics are shared between processes, which needs them lock free */
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+              sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+struct ShmPool::Region {
+  uint32_t magic;
+  int concurrency;
+  uint64_t shared_size;
+  pid_t parent;
+  std::atomic<int> status;  // a PoolStatus
+  std::atomic<uint64_t> submitted;
+  std::atomic<uint64_t> failed;
+  /* finished without running: given up after crashes, or on Shutdown() */
+  std::atomic<uint64_t> dropped;
+  std::atomic<int> sleepers;
+  std::atomic<int> waiters;
+  /* futex words, bumped on every wake-up */
+  std::atomic<uint32_t> work_seq;
+  std::atomic<uint32_t> done_seq;
+};
+
+struct alignas(64) ShmPool::Queue {
+  pthread_mutex_t mutex;
+  /* free running, written under the mutex, read outside of it as a hint */
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+  ShmTask ring[SHM_QUEUE_CAPACITY];
+};
+
+struct alignas(64) ShmPool::Slot {
+  /* tasks done << 1 | running one, only written by the worker while alive */
+  std::atomic<uint64_t> state;
+  ShmTask running;
+};
+
+auto ShmPool::MappingSize(int concurrency, size_t shared_size) -> size_t {
+  return Align(sizeof(Region)) + concurrency * sizeof(Queue) +
+         concurrency * sizeof(Slot) + Align(shared_size);
+}
+
+auto ShmPool::MapParts(void* base, int concurrency, size_t shared_size)
+    -> Mapping {
+  char* at = static_cast<char*>(base);
+  Mapping mapping;
+  mapping.region = reinterpret_cast<Region*>(at);
+  at += Align(sizeof(Region));
+  mapping.queues = reinterpret_cast<Queue*>(at);
+  at += concurrency * sizeof(Queue);
+  mapping.slots = reinterpret_cast<Slot*>(at);
+  at += concurrency * sizeof(Slot);
+  mapping.area = shared_size > 0 ? at : nullptr;
+  mapping.length = MappingSize(concurrency, shared_size);
+  return mapping;
+}
+
+ShmPool::ShmPool(int concurrency, size_t shared_size)
+    : concurrency_(concurrency),
+      pids_(new pid_t[concurrency]()) {
+  static std::atomic<int> pool_count{0};
+  name_ = "/zorro-" + std::to_string(getpid()) + "-" +
+          std::to_string(pool_count.fetch_add(1));
+  int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    ThrowErrno("shm_open");
+  }
+  size_t length = MappingSize(concurrency, shared_size);
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(length)) == 0) {
+    base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    throw std::system_error(error, std::generic_category(), "mmap");
+  }
+  // a fresh region reads as zeros, only the non-trivial parts need setting up
+  mapping_ = MapParts(base, concurrency, shared_size);
+  Region* region = new (mapping_.region) Region();
+  region->concurrency = concurrency;
+  region->shared_size = shared_size;
+  region->parent = getpid();
+  region->status.store(static_cast<int>(PoolStatus::RUNNING));
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+  for (int i = 0; i < concurrency; i++) {
+    Queue* queue = new (&mapping_.queues[i]) Queue();
+    pthread_mutex_init(&queue->mutex, &attr);
+    new (&mapping_.slots[i]) Slot();
+  }
+  pthread_mutexattr_destroy(&attr);
+  std::atomic_thread_fence(std::memory_order_release);
+  region->magic = kRegionMagic;
+
+  try {
+    for (int i = 0; i < concurrency; i++) {
+      pids_[i] = Spawn(i);
+    }
+  } catch (...) {
+    // send away the workers that did start, and leave nothing behind
+    region->status.store(static_cast<int>(PoolStatus::SHUTDOWN));
+    WakeWorkers(true);
+    for (int i = 0; i < concurrency && pids_[i] != 0; i++) {
+      waitpid(pids_[i], nullptr, 0);
+    }
+    munmap(mapping_.region, mapping_.length);
+    shm_unlink(name_.c_str());
+    throw;
+  }
+  supervisor_ = std::thread([this]() { Supervise(); });
+}
+
+ShmPool::~ShmPool() {
+  Exit();
+  munmap(mapping_.region, mapping_.length);
+  shm_unlink(name_.c_str());
+}
+
+void ShmPool::Submit(uint32_t function_id, const void* arg, size_t size) {
+  if (size > SHM_ARG_SIZE) {
+    throw std::length_error("task argument exceeds SHM_ARG_SIZE");
+  }
+  ShmTask task;
+  task.function_id = function_id;
+  task.size = static_cast<uint32_t>(size);
+  task.retries = 0;
+  task.reserved = 0;
+  memcpy(task.arg, arg, size);
+  // counted first, so a waiter never sees it finished before submitted
+  mapping_.region->submitted.fetch_add(1, std::memory_order_relaxed);
+  Enqueue(task);
+  WakeWorkers(false);
+}
+
+void ShmPool::Enqueue(const ShmTask& task) {
+  uint32_t start = ticket_.fetch_add(1, std::memory_order_relaxed);
+  for (;;) {
+    for (int i = 0; i < concurrency_; i++) {
+      Queue& queue = mapping_.queues[(start + i) % concurrency_];
+      LockRobust(&queue.mutex);
+      uint32_t tail = queue.tail.load(std::memory_order_relaxed);
+      if (tail - queue.head.load(std::memory_order_relaxed) <
+          SHM_QUEUE_CAPACITY) {
+        queue.ring[tail % SHM_QUEUE_CAPACITY] = task;
+        // seq_cst, against the sleepers count read in WakeWorkers()
+        queue.tail.store(tail + 1, std::memory_order_seq_cst);
+        pthread_mutex_unlock(&queue.mutex);
+        return;
+      }
+      pthread_mutex_unlock(&queue.mutex);
+    }
+    // every ring is full, let the workers catch up
+    WakeWorkers(true);
+    std::this_thread::yield();
+  }
+}
+
+void ShmPool::WakeWorkers(bool all) {
+  Region* region = mapping_.region;
+  if (all || region->sleepers.load(std::memory_order_seq_cst) > 0) {
+    region->work_seq.fetch_add(1, std::memory_order_seq_cst);
+    FutexWake(&region->work_seq, all ? INT_MAX : 1);
+  }
+}
+
+auto ShmPool::FinishedCount() -> uint64_t {
+  uint64_t finished =
+      mapping_.region->dropped.load(std::memory_order_seq_cst);
+  for (int i = 0; i < concurrency_; i++) {
+    finished += mapping_.slots[i].state.load(std::memory_order_seq_cst) >> 1;
+  }
+  return finished;
+}
+
+void ShmPool::WaitUntilFinished() {
+  Region* region = mapping_.region;
+  for (;;) {
+    uint32_t seq = region->done_seq.load(std::memory_order_seq_cst);
+    region->waiters.fetch_add(1, std::memory_order_seq_cst);
+    bool finished = FinishedCount() >=
+                    region->submitted.load(std::memory_order_relaxed);
+    if (!finished) {
+      FutexWait(&region->done_seq, seq, SHM_WAIT_MILLIS);
+    }
+    region->waiters.fetch_sub(1, std::memory_order_relaxed);
+    if (finished) {
+      return;
+    }
+  }
+}
+
+void ShmPool::Exit() {
+  if (!supervisor_.joinable()) {
+    return;
+  }
+  int running = static_cast<int>(PoolStatus::RUNNING);
+  mapping_.region->status.compare_exchange_strong(
+      running, static_cast<int>(PoolStatus::EXIT), std::memory_order_release);
+  WakeWorkers(true);
+  // the supervisor leaves once every worker has, crashed ones respawned
+  supervisor_.join();
+}
+
+void ShmPool::Shutdown() {
+  mapping_.region->status.store(static_cast<int>(PoolStatus::SHUTDOWN),
+                                std::memory_order_release);
+  Exit();
+  // no worker is left, count what they abandoned as given up on
+  uint64_t abandoned = 0;
+  for (int i = 0; i < concurrency_; i++) {
+    Queue& queue = mapping_.queues[i];
+    abandoned += queue.tail.load(std::memory_order_relaxed) -
+                 queue.head.load(std::memory_order_relaxed);
+    queue.head.store(queue.tail.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
+  }
+  mapping_.region->dropped.fetch_add(abandoned, std::memory_order_seq_cst);
+}
+
+auto ShmPool::GetFailedCount() -> uint64_t {
+  return mapping_.region->failed.load(std::memory_order_acquire);
+}
+
+auto ShmPool::GetSharedArea() -> void* { return mapping_.area; }
+
+auto ShmPool::Spawn(int id) -> pid_t {
+  std::string index = std::to_string(id);
+  char* argv[] = {const_cast<char*>("/proc/self/exe"),
+                  const_cast<char*>(SHM_WORKER_ARG),
+                  const_cast<char*>(name_.c_str()),
+                  const_cast<char*>(index.c_str()), nullptr};
+  pid_t pid;
+  // exec the program afresh rather than fork this multithreaded one
+  int error = posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv,
+                          environ);
+  if (error != 0) {
+    throw std::system_error(error, std::generic_category(), "posix_spawn");
+  }
+  return pid;
+}
+
+void ShmPool::Supervise() {
+  for (;;) {
+    bool alive = false;
+    for (int i = 0; i < concurrency_; i++) {
+      if (pids_[i] == 0) {
+        continue;
+      }
+      int wait_status;
+      if (waitpid(pids_[i], &wait_status, WNOHANG) == pids_[i]) {
+        pids_[i] = 0;
+        Recover(i, wait_status);
+      }
+      alive = alive || pids_[i] != 0;
+    }
+    if (!alive) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(SHM_WAIT_MILLIS));
+  }
+}
+
+void ShmPool::Recover(int id, int wait_status) {
+  Region* region = mapping_.region;
+  Slot& slot = mapping_.slots[id];
+  uint64_t state = slot.state.load(std::memory_order_acquire);
+  bool requeue = false;
+  ShmTask task;
+  if ((state & 1) != 0) {
+    // it died running a task, the worker is gone so the slot is ours now
+    task = slot.running;
+    slot.state.store(state & ~uint64_t(1), std::memory_order_relaxed);
+    requeue = task.retries++ < SHM_MAX_RETRIES;
+    if (!requeue) {
+      region->failed.fetch_add(1, std::memory_order_relaxed);
+      region->dropped.fetch_add(1, std::memory_order_seq_cst);
+    }
+  }
+  auto status = static_cast<PoolStatus>(
+      region->status.load(std::memory_order_acquire));
+  bool clean = WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0;
+  // a worker only leaves by itself once the pool is done with it, and the
+  // others may have left already when it leaves work behind
+  if (status == PoolStatus::RUNNING ||
+      (status == PoolStatus::EXIT &&
+       (!clean || requeue || AnyQueued(mapping_)))) {
+    pids_[id] = Spawn(id);
+    respawns_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (requeue) {
+    Enqueue(task);
+    WakeWorkers(false);
+  }
+  region->done_seq.fetch_add(1, std::memory_order_seq_cst);
+  FutexWake(&region->done_seq, INT_MAX);
+}
+
+auto ShmPool::WorkerMain(const char* name, int id) -> int {
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    perror("shm_open");
+    return 1;
+  }
+  struct stat info;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &info) == 0) {
+    base = mmap(nullptr, static_cast<size_t>(info.st_size),
+                PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  Region* region = static_cast<Region*>(base);
+  if (region->magic != kRegionMagic || id < 0 || id >= region->concurrency) {
+    fprintf(stderr, "shm-worker: %s is not a pool region\n", name);
+    return 1;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  Mapping mapping = MapParts(base, region->concurrency, region->shared_size);
+  worker_area_ = mapping.area;
+  WorkerLoop(mapping, id);
+  munmap(base, mapping.length);
+  return 0;
+}
+
+void ShmPool::WorkerLoop(const Mapping& mapping, int id) {
+  Region* region = mapping.region;
+  while (getppid() == region->parent) {
+    auto status = static_cast<PoolStatus>(
+        region->status.load(std::memory_order_acquire));
+    if (status == PoolStatus::SHUTDOWN) {
+      return;
+    }
+    if (TakeTask(mapping, id)) {
+      continue;
+    }
+    if (status == PoolStatus::EXIT) {
+      // every queue was empty after the last submission
+      return;
+    }
+    uint32_t seq = region->work_seq.load(std::memory_order_seq_cst);
+    region->sleepers.fetch_add(1, std::memory_order_seq_cst);
+    if (!AnyQueued(mapping) && region->status.load(std::memory_order_seq_cst) ==
+                                   static_cast<int>(PoolStatus::RUNNING)) {
+      FutexWait(&region->work_seq, seq, SHM_WAIT_MILLIS);
+    }
+    region->sleepers.fetch_sub(1, std::memory_order_relaxed);
+  }
+  // the pool owner is gone, nobody is left to wait for the results
+}
+
+auto ShmPool::AnyQueued(const Mapping& mapping) -> bool {
+  for (int i = 0; i < mapping.region->concurrency; i++) {
+    Queue& queue = mapping.queues[i];
+    if (queue.tail.load(std::memory_order_seq_cst) !=
+        queue.head.load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto ShmPool::TakeTask(const Mapping& mapping, int id) -> bool {
+  Region* region = mapping.region;
+  Slot& slot = mapping.slots[id];
+  int concurrency = region->concurrency;
+  uint64_t done = slot.state.load(std::memory_order_relaxed) >> 1;
+  // own queue first, then steal from the others in turn
+  for (int i = 0; i < concurrency; i++) {
+    Queue& queue = mapping.queues[(id + i) % concurrency];
+    if (queue.tail.load(std::memory_order_relaxed) ==
+        queue.head.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    LockRobust(&queue.mutex);
+    uint32_t head = queue.head.load(std::memory_order_relaxed);
+    if (queue.tail.load(std::memory_order_relaxed) == head) {
+      pthread_mutex_unlock(&queue.mutex);
+      continue;
+    }
+    slot.running = queue.ring[head % SHM_QUEUE_CAPACITY];
+    slot.state.store(done << 1 | 1, std::memory_order_release);
+    queue.head.store(head + 1, std::memory_order_relaxed);
+    pthread_mutex_unlock(&queue.mutex);
+
+    const ShmTask& task = slot.running;
+    RemoteFunction function = TaskRegistry::Find(task.function_id);
+    if (function == nullptr) {
+      region->failed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      try {
+        function(task.arg, task.size);
+      } catch (...) {
+        region->failed.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    // one store both counts the task done and clears the busy bit
+    slot.state.store((done + 1) << 1, std::memory_order_seq_cst);
+    if (region->waiters.load(std::memory_order_seq_cst) > 0) {
+      region->done_seq.fetch_add(1, std::memory_order_seq_cst);
+      FutexWake(&region->done_seq, INT_MAX);
+    }
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file shm_pool.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the shared-memory multi-process pool
+ * the queues live in a shm_open()/mmap() region, and the workers are
+ * processes of their own that attach to it and take task descriptors off
+ * any queue: a function ID from the TaskRegistry plus an inline argument
+ *
+ * a worker that crashes takes only itself down: the pool puts the task it
+ * was running back on a queue, up to SHM_MAX_RETRIES times, and respawns it,
+ * so a task runs at least once, and more than once only after a crash
+ *
+ * the workers are this same program started again, see WorkerMain(), so
+ * they register the same tasks under the same IDs
+ */
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "task_registry.h"
+
+/* bytes of argument a descriptor carries, which makes it 128 bytes */
+#define SHM_ARG_SIZE 112
+/* descriptors one worker queue holds, Submit() waits when all are full */
+#define SHM_QUEUE_CAPACITY 4096
+/* how often a task is run again after its worker died running it */
+#define SHM_MAX_RETRIES 1
+/* idle workers and waiters recheck on their own after this long */
+#define SHM_WAIT_MILLIS 10
+/* argv[1] that turns the program into a worker process */
+#define SHM_WORKER_ARG "shm-worker"
+
+/* position independent, means the same in every process */
+struct ShmTask {
+  uint32_t function_id;
+  uint32_t size;
+  uint32_t retries;
+  uint32_t reserved;
+  char arg[SHM_ARG_SIZE];
+};
+
+class ShmPool {
+ public:
+  /**
+   * Create the region with shared_size bytes for the tasks to share, see
+   * SharedArea(), and spawn concurrency worker processes
+   * throws std::system_error when the region or a worker cannot be made
+   */
+  explicit ShmPool(int concurrency, size_t shared_size = 0);
+
+  /* drains the queues like Exit(), then removes the region */
+  ~ShmPool();
+
+  ShmPool(const ShmPool&) = delete;
+  ShmPool& operator=(const ShmPool&) = delete;
+
+  /**
+   * Queue the task registered under function_id with a copy of arg
+   * only the process that created the pool submits
+   * throws std::length_error when size exceeds SHM_ARG_SIZE
+   */
+  void Submit(uint32_t function_id, const void* arg, size_t size);
+
+  template <typename T>
+  void Submit(uint32_t function_id, const T& arg) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "the argument is copied into another process as bytes");
+    Submit(function_id, &arg, sizeof(T));
+  }
+
+  /* block until every submitted task has run, or has been given up on */
+  void WaitUntilFinished();
+
+  /* workers drain the queues and leave, returns once all of them have */
+  void Exit();
+
+  /* workers leave right away, tasks still queued are given up on */
+  void Shutdown();
+
+  auto GetConcurrency() -> int { return concurrency_; }
+
+  /* tasks that threw, had no registered function, or kept crashing */
+  auto GetFailedCount() -> uint64_t;
+
+  /* worker processes started again after dying */
+  auto GetRespawnCount() -> uint64_t { return respawns_; }
+
+  /* the shared_size bytes for the tasks, zeroed at creation */
+  auto GetSharedArea() -> void*;
+
+  /* in a worker process, the shared area of the pool it works for */
+  static auto SharedArea() -> void* { return worker_area_; }
+
+  /**
+   * Entry point of a worker process, main() calls it when argv[1] is
+   * SHM_WORKER_ARG, with argv[2] the region name and argv[3] the worker id
+   * @return the process exit status
+   */
+  static auto WorkerMain(const char* name, int id) -> int;
+
+ private:
+  struct Region;
+  struct Queue;
+  struct Slot;
+
+  /* the parts of the mapping, the same layout in every process */
+  struct Mapping {
+    Region* region;
+    Queue* queues;
+    Slot* slots;
+    void* area;
+    size_t length;
+  };
+
+  static auto MappingSize(int concurrency, size_t shared_size) -> size_t;
+  static auto MapParts(void* base, int concurrency, size_t shared_size)
+      -> Mapping;
+
+  /* put task on the first queue with room, starting at a rotating one */
+  void Enqueue(const ShmTask& task);
+  void WakeWorkers(bool all);
+  auto Spawn(int id) -> pid_t;
+  /* reap dead workers, requeue what they were running, respawn them */
+  void Supervise();
+  void Recover(int id, int wait_status);
+  auto FinishedCount() -> uint64_t;
+
+  static void WorkerLoop(const Mapping& mapping, int id);
+  static auto TakeTask(const Mapping& mapping, int id) -> bool;
+  static auto AnyQueued(const Mapping& mapping) -> bool;
+
+  int concurrency_;
+  std::string name_;
+  Mapping mapping_;
+  std::unique_ptr<pid_t[]> pids_;  // only touched by the supervisor
+  std::atomic<uint64_t> respawns_{0};
+  std::atomic<uint32_t> ticket_{0};
+  std::thread supervisor_;
+
+  inline static void* worker_area_ = nullptr;
+};
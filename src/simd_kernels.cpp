@@ -0,0 +1,362 @@
+/**
+ * @file simd_kernels.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the per-block kernels
+ * the vector flavors are compiled with target attributes, so the binary
+ * still runs on a CPU without them and no extra -m flags are needed
+ */
+
+#include "simd_kernels.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZORRO_X86 1
+#include <immintrin.h>
+#endif
+
+/* --- scalar fallback --- */
+
+static int SumScalar(const int *in, size_t n) {
+  uint32_t acc = 0;
+  for (size_t i = 0; i < n; i++) {
+    acc += static_cast<uint32_t>(in[i]);
+  }
+  return static_cast<int>(acc);
+}
+
+static void ScanScalar(const int *in, int *out, size_t n, int carry) {
+  uint32_t acc = static_cast<uint32_t>(carry);
+  for (size_t i = 0; i < n; i++) {
+    acc += static_cast<uint32_t>(in[i]);
+    out[i] = static_cast<int>(acc);
+  }
+}
+
+static size_t CountGreaterScalar(const int *in, size_t n, int pivot) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    count += in[i] > pivot;
+  }
+  return count;
+}
+
+static void FilterGreaterScalar(const int *in, size_t n, int pivot, int *out,
+                                size_t out_count) {
+  (void)out_count;
+  for (size_t i = 0; i < n; i++) {
+    if (in[i] > pivot) {
+      *out++ = in[i];
+    }
+  }
+}
+
+static void HistogramScalar(const int *in, size_t n, int shift, int bits,
+                            uint64_t *hist) {
+  uint32_t mask = (1u << bits) - 1;
+  for (size_t i = 0; i < n; i++) {
+    hist[(static_cast<uint32_t>(in[i]) >> shift) & mask]++;
+  }
+}
+
+/*
+ * Increment the bins of a run of precomputed indices
+ * four interleaved sub-histograms keep repeated bins from forming a chain
+ * of dependent read-modify-writes on the same counter
+ */
+static void CountIndices(const uint32_t *idx, size_t n, int bits,
+                         uint64_t *sub, uint64_t *hist) {
+  size_t bins = size_t(1) << bits;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    sub[idx[i]]++;
+    sub[bins + idx[i + 1]]++;
+    sub[2 * bins + idx[i + 2]]++;
+    sub[3 * bins + idx[i + 3]]++;
+  }
+  for (; i < n; i++) {
+    hist[idx[i]]++;
+  }
+}
+
+static void MergeSubHistograms(const uint64_t *sub, int bits,
+                               uint64_t *hist) {
+  size_t bins = size_t(1) << bits;
+  for (size_t b = 0; b < bins; b++) {
+    hist[b] += sub[b] + sub[bins + b] + sub[2 * bins + b] + sub[3 * bins + b];
+  }
+}
+
+#ifdef ZORRO_X86
+
+/* how many ints are binned at once before their bins are incremented */
+#define HISTOGRAM_CHUNK 256
+
+/* --- SSE4.1, 4 lanes --- */
+
+/* pshufb patterns moving the selected lanes to the front */
+struct SseCompressTable {
+  alignas(16) uint8_t shuffle[16][16];
+  SseCompressTable() {
+    for (int mask = 0; mask < 16; mask++) {
+      int k = 0;
+      for (int lane = 0; lane < 4; lane++) {
+        if (mask & (1 << lane)) {
+          for (int byte = 0; byte < 4; byte++) {
+            shuffle[mask][k * 4 + byte] = static_cast<uint8_t>(lane * 4 + byte);
+          }
+          k++;
+        }
+      }
+      for (; k < 4; k++) {
+        for (int byte = 0; byte < 4; byte++) {
+          shuffle[mask][k * 4 + byte] = 0x80;  // zero the unused lanes
+        }
+      }
+    }
+  }
+};
+static const SseCompressTable sse_compress;
+
+__attribute__((target("sse4.1"))) static int SumSse(const int *in, size_t n) {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm_add_epi32(acc, _mm_loadu_si128((const __m128i *)(in + i)));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+  uint32_t total = static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+  total += static_cast<uint32_t>(SumScalar(in + i, n - i));
+  return static_cast<int>(total);
+}
+
+__attribute__((target("sse4.1"))) static void ScanSse(const int *in, int *out,
+                                                      size_t n, int carry) {
+  __m128i running = _mm_set1_epi32(carry);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+    // log-step scan inside the register
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi32(x, running);
+    _mm_storeu_si128((__m128i *)(out + i), x);
+    running = _mm_shuffle_epi32(x, 0xFF);
+  }
+  ScanScalar(in + i, out + i, n - i, _mm_cvtsi128_si32(running));
+}
+
+__attribute__((target("sse4.1,popcnt"))) static size_t CountGreaterSse(
+    const int *in, size_t n, int pivot) {
+  __m128i p = _mm_set1_epi32(pivot);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i gt = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i *)(in + i)), p);
+    count += _mm_popcnt_u32(_mm_movemask_ps(_mm_castsi128_ps(gt)));
+  }
+  return count + CountGreaterScalar(in + i, n - i, pivot);
+}
+
+__attribute__((target("sse4.1,popcnt"))) static void FilterGreaterSse(
+    const int *in, size_t n, int pivot, int *out, size_t out_count) {
+  __m128i p = _mm_set1_epi32(pivot);
+  size_t written = 0;
+  size_t i = 0;
+  // full stores as long as the whole vector lands inside this block's output
+  for (; i + 4 <= n && written + 4 <= out_count; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(in + i));
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, p)));
+    __m128i shuffle =
+        _mm_load_si128((const __m128i *)sse_compress.shuffle[mask]);
+    _mm_storeu_si128((__m128i *)(out + written), _mm_shuffle_epi8(x, shuffle));
+    written += _mm_popcnt_u32(mask);
+  }
+  FilterGreaterScalar(in + i, n - i, pivot, out + written, out_count - written);
+}
+
+__attribute__((target("sse4.1"))) static void HistogramSse(const int *in,
+                                                           size_t n, int shift,
+                                                           int bits,
+                                                           uint64_t *hist) {
+  std::vector<uint64_t> sub(size_t(4) << bits);
+  alignas(16) uint32_t idx[HISTOGRAM_CHUNK];
+  __m128i mask = _mm_set1_epi32((1 << bits) - 1);
+  __m128i count = _mm_cvtsi32_si128(shift);
+  size_t i = 0;
+  while (i < n) {
+    size_t chunk = n - i < HISTOGRAM_CHUNK ? n - i : HISTOGRAM_CHUNK;
+    size_t k = 0;
+    for (; k + 4 <= chunk; k += 4) {
+      __m128i x = _mm_loadu_si128((const __m128i *)(in + i + k));
+      x = _mm_and_si128(_mm_srl_epi32(x, count), mask);
+      _mm_store_si128((__m128i *)(idx + k), x);
+    }
+    for (; k < chunk; k++) {
+      idx[k] = (static_cast<uint32_t>(in[i + k]) >> shift) & ((1u << bits) - 1);
+    }
+    CountIndices(idx, chunk, bits, sub.data(), hist);
+    i += chunk;
+  }
+  MergeSubHistograms(sub.data(), bits, hist);
+}
+
+/* --- AVX2, 8 lanes --- */
+
+/* permutevar8x32 indices moving the selected lanes to the front */
+struct AvxCompressTable {
+  alignas(32) int32_t index[256][8];
+  AvxCompressTable() {
+    for (int mask = 0; mask < 256; mask++) {
+      int k = 0;
+      for (int lane = 0; lane < 8; lane++) {
+        if (mask & (1 << lane)) {
+          index[mask][k++] = lane;
+        }
+      }
+      for (; k < 8; k++) {
+        index[mask][k] = 0;
+      }
+    }
+  }
+};
+static const AvxCompressTable avx_compress;
+
+__attribute__((target("avx2"))) static int SumAvx2(const int *in, size_t n) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc = _mm256_add_epi32(acc, _mm256_loadu_si256((const __m256i *)(in + i)));
+  }
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                               _mm256_extracti128_si256(acc, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+  uint32_t total = static_cast<uint32_t>(_mm_cvtsi128_si32(half));
+  total += static_cast<uint32_t>(SumScalar(in + i, n - i));
+  return static_cast<int>(total);
+}
+
+__attribute__((target("avx2"))) static void ScanAvx2(const int *in, int *out,
+                                                     size_t n, int carry) {
+  __m256i running = _mm256_set1_epi32(carry);
+  __m256i last_lane = _mm256_set1_epi32(7);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+    // log-step scan inside each 128-bit half
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    // carry the total of the low half into the high half
+    __m256i low_total = _mm256_shuffle_epi32(x, 0xFF);
+    x = _mm256_add_epi32(x,
+                         _mm256_permute2x128_si256(low_total, low_total, 0x08));
+    x = _mm256_add_epi32(x, running);
+    _mm256_storeu_si256((__m256i *)(out + i), x);
+    running = _mm256_permutevar8x32_epi32(x, last_lane);
+  }
+  ScanScalar(in + i, out + i, n - i,
+             _mm_cvtsi128_si32(_mm256_castsi256_si128(running)));
+}
+
+__attribute__((target("avx2,popcnt"))) static size_t CountGreaterAvx2(
+    const int *in, size_t n, int pivot) {
+  __m256i p = _mm256_set1_epi32(pivot);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i gt =
+        _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(in + i)), p);
+    count += _mm_popcnt_u32(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+  }
+  return count + CountGreaterScalar(in + i, n - i, pivot);
+}
+
+__attribute__((target("avx2,popcnt"))) static void FilterGreaterAvx2(
+    const int *in, size_t n, int pivot, int *out, size_t out_count) {
+  __m256i p = _mm256_set1_epi32(pivot);
+  size_t written = 0;
+  size_t i = 0;
+  // full stores as long as the whole vector lands inside this block's output
+  for (; i + 8 <= n && written + 8 <= out_count; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+    int mask =
+        _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, p)));
+    __m256i index =
+        _mm256_load_si256((const __m256i *)avx_compress.index[mask]);
+    _mm256_storeu_si256((__m256i *)(out + written),
+                        _mm256_permutevar8x32_epi32(x, index));
+    written += _mm_popcnt_u32(mask);
+  }
+  FilterGreaterScalar(in + i, n - i, pivot, out + written, out_count - written);
+}
+
+__attribute__((target("avx2"))) static void HistogramAvx2(const int *in,
+                                                          size_t n, int shift,
+                                                          int bits,
+                                                          uint64_t *hist) {
+  std::vector<uint64_t> sub(size_t(4) << bits);
+  alignas(32) uint32_t idx[HISTOGRAM_CHUNK];
+  __m256i mask = _mm256_set1_epi32((1 << bits) - 1);
+  __m128i count = _mm_cvtsi32_si128(shift);
+  size_t i = 0;
+  while (i < n) {
+    size_t chunk = n - i < HISTOGRAM_CHUNK ? n - i : HISTOGRAM_CHUNK;
+    size_t k = 0;
+    for (; k + 8 <= chunk; k += 8) {
+      __m256i x = _mm256_loadu_si256((const __m256i *)(in + i + k));
+      x = _mm256_and_si256(_mm256_srl_epi32(x, count), mask);
+      _mm256_store_si256((__m256i *)(idx + k), x);
+    }
+    for (; k < chunk; k++) {
+      idx[k] = (static_cast<uint32_t>(in[i + k]) >> shift) & ((1u << bits) - 1);
+    }
+    CountIndices(idx, chunk, bits, sub.data(), hist);
+    i += chunk;
+  }
+  MergeSubHistograms(sub.data(), bits, hist);
+}
+
+#endif  // ZORRO_X86
+
+static const SimdKernels scalar_kernels = {
+    "scalar",           SumScalar,          ScanScalar, CountGreaterScalar,
+    FilterGreaterScalar, HistogramScalar};
+
+#ifdef ZORRO_X86
+static const SimdKernels sse_kernels = {"sse4.1",        SumSse,
+                                        ScanSse,         CountGreaterSse,
+                                        FilterGreaterSse, HistogramSse};
+
+static const SimdKernels avx2_kernels = {"avx2",            SumAvx2,
+                                         ScanAvx2,          CountGreaterAvx2,
+                                         FilterGreaterAvx2, HistogramAvx2};
+#endif
+
+static auto SelectKernels() -> const SimdKernels * {
+  const char *cap = std::getenv("ZORRO_SIMD");
+  std::string limit = cap == nullptr ? "avx2" : cap;
+#ifdef ZORRO_X86
+  __builtin_cpu_init();
+  if (limit == "avx2" && __builtin_cpu_supports("avx2") &&
+      __builtin_cpu_supports("popcnt")) {
+    return &avx2_kernels;
+  }
+  if ((limit == "avx2" || limit == "sse") && __builtin_cpu_supports("sse4.1") &&
+      __builtin_cpu_supports("popcnt")) {
+    return &sse_kernels;
+  }
+#endif
+  return &scalar_kernels;
+}
+
+auto GetSimdKernels() -> const SimdKernels & {
+  static const SimdKernels *kernels = SelectKernels();
+  return *kernels;
+}
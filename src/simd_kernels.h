@@ -0,0 +1,44 @@
+/**
+ * @file simd_kernels.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the per-block kernels behind the
+ * parallel primitives, in AVX2, SSE4.1 and scalar flavors
+ * the flavor is picked once at runtime from what the CPU supports
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * One set of kernels, every pointer works on a single block of ints
+ * the arithmetic wraps around like unsigned int does
+ */
+struct SimdKernels {
+  const char *name;
+  /* sum of in[0..n) */
+  int (*sum)(const int *in, size_t n);
+  /* inclusive prefix sum of in[0..n) into out, starting from carry */
+  void (*scan)(const int *in, int *out, size_t n, int carry);
+  /* how many of in[0..n) are greater than pivot */
+  size_t (*count_greater)(const int *in, size_t n, int pivot);
+  /*
+   * copy the elements greater than pivot to out, keeping their order
+   * out_count is the exact number of them, nothing is written past it
+   */
+  void (*filter_greater)(const int *in, size_t n, int pivot, int *out,
+                         size_t out_count);
+  /* add one to hist[(in[i] >> shift) & (2^bits - 1)] for every element */
+  void (*histogram)(const int *in, size_t n, int shift, int bits,
+                    uint64_t *hist);
+};
+
+/*
+ * The best kernels this CPU supports, chosen on the first call
+ * setting the environment ZORRO_SIMD to avx2, sse or scalar caps the choice
+ */
+auto GetSimdKernels() -> const SimdKernels &;
@@ -0,0 +1,45 @@
+/**
+ * @file strand.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the Strand
+ * the scheduled flag guarantees at most one drain task per strand
+ *
+ * Post() pushes then tests the flag, Drain() clears the flag then tests the
+ * queue: a store followed by a load on another location on each side, which
+ * only seq_cst keeps from being reordered, so those accesses stay seq_cst
+ */
+
+#include "strand.h"
+
+Strand::Strand(BasePool& pool) : state_(std::make_shared<State>(pool)) {}
+
+void Strand::Post(Task task) {
+  state_->queue.push(std::move(task));
+  if (!state_->scheduled.exchange(true, std::memory_order_seq_cst)) {
+    // the strand was idle, hand it to the pool
+    auto state = state_;
+    state_->pool.Submit([state]() { Drain(state); });
+  }
+}
+
+void Strand::Drain(const std::shared_ptr<State>& state) {
+  Task task;
+  for (int i = 0; i < STRAND_BATCH_SIZE; i++) {
+    if (!state->queue.pop(task)) {
+      state->scheduled.store(false, std::memory_order_seq_cst);
+      // a Post() that started before the flag was cleared did not schedule
+      // a drain, so take the strand back unless a new drain got it first
+      if (state->queue.empty() ||
+          state->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        return;
+      }
+      continue;
+    }
+    state->pool.RunTask(task);
+  }
+  // give the worker back to other tasks, the strand stays scheduled
+  state->pool.Submit([state]() { Drain(state); });
+}
@@ -0,0 +1,47 @@
+/**
+ * @file strand.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the Strand, a serialized executor
+ * layered on any threadpool without owning a thread
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "base_pool.h"
+#include "mpsc_queue.h"
+
+/* how many tasks a strand runs before giving its worker back to the pool */
+#define STRAND_BATCH_SIZE 64
+
+/*
+ * Tasks posted to a Strand run in FIFO order and never concurrently,
+ * on whichever worker of the pool is free
+ * An idle strand is one stub node and a flag, it costs no thread and no task
+ */
+class Strand {
+ public:
+  explicit Strand(BasePool& pool);
+
+  /* safe to call from any thread, including from inside the strand */
+  void Post(Task task);
+
+ private:
+  /* outlives the Strand while a drain is still scheduled on the pool */
+  struct State {
+    explicit State(BasePool& pool) : pool(pool) {}
+    BasePool& pool;
+    mpsc_queue<Task> queue;
+    /* whether a drain task is queued or running for this strand */
+    std::atomic<bool> scheduled{false};
+  };
+
+  static void Drain(const std::shared_ptr<State>& state);
+
+  std::shared_ptr<State> state_;
+};
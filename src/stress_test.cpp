@@ -0,0 +1,339 @@
+/**
+ * @file stress_test.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the stress suite
+ * the randomness is a hash of (seed, task id), so a task makes the same
+ * choices in every run with the same seed, only the schedule differs
+ */
+
+#include "stress_test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "elastic_pool.h"
+#include "fiber_pool.h"
+#include "global_pool.h"
+#include "local_coarse_pool.h"
+#include "local_fine_pool.h"
+#include "local_fine_pool_log_steal.h"
+#include "local_fine_pool_naive_steal.h"
+#include "policy_pool.h"
+#include "timer.h"
+
+/* splitmix64 of seed and id, the dice of task id */
+static auto Mix(uint64_t seed, uint64_t id) -> uint64_t {
+  uint64_t x = seed + (id + 1) * 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/*
+ * Perturb the schedule around task id: mostly a short spin, sometimes a
+ * yield and rarely a sleep, all of which suspend just the fiber on a FiberPool
+ */
+static void Chaos(uint64_t seed, uint64_t id) {
+  uint64_t dice = Mix(seed, id);
+  uint64_t amount = dice >> 8;
+  if (dice % 64 == 0) {
+    Fiber::Sleep(std::chrono::microseconds(amount % 200));
+  } else if (dice % 8 == 0) {
+    Fiber::Yield();
+  } else {
+    for (volatile uint64_t spin = 0; spin < amount % 256; spin++) {
+    }
+  }
+}
+
+/* how many times every task id has run */
+class Ledger {
+ public:
+  explicit Ledger(size_t size) : hits_(size) {}
+
+  void Hit(uint64_t id) { hits_[id].fetch_add(1, std::memory_order_relaxed); }
+
+  /**
+   * Check that the ids below expected ran exactly once and the others never
+   * with may_lose, the ids below expected may also not have run at all
+   * @return whether they did, otherwise the damage is printed
+   */
+  auto Check(const char* scenario, size_t expected, bool may_lose = false)
+      -> bool {
+    size_t lost = 0;
+    size_t duplicated = 0;
+    size_t first_bad = hits_.size();
+    for (size_t id = 0; id < hits_.size(); id++) {
+      uint32_t hits = hits_[id].load(std::memory_order_relaxed);
+      uint32_t want = id < expected ? 1 : 0;
+      if (hits == want || (may_lose && hits == 0)) {
+        continue;
+      }
+      (hits < want ? lost : duplicated)++;
+      first_bad = std::min(first_bad, id);
+    }
+    if (lost == 0 && duplicated == 0) {
+      return true;
+    }
+    std::cout << scenario << ": " << lost << " tasks lost, " << duplicated
+              << " run more than once, first at id " << first_bad << std::endl;
+    return false;
+  }
+
+  /* how many ids have run at least once */
+  auto Count() -> size_t {
+    return std::count_if(hits_.begin(), hits_.end(), [](auto& hits) {
+      return hits.load(std::memory_order_relaxed) > 0;
+    });
+  }
+
+ private:
+  std::vector<std::atomic<uint32_t>> hits_;
+};
+
+/* the state shared by all tasks of one nested_submit_test() */
+struct NestedState {
+  BasePool& pool;
+  Ledger& ledger;
+  uint64_t seed;
+  std::atomic<uint64_t> next_id{0};
+};
+
+static void NestedTask(NestedState* state, uint64_t id) {
+  Chaos(state->seed, id);
+  state->ledger.Hit(id);
+  uint64_t children = Mix(~state->seed, id) % (STRESS_FANOUT + 1);
+  for (uint64_t c = 0; c < children; c++) {
+    uint64_t child = state->next_id.fetch_add(1, std::memory_order_relaxed);
+    if (child >= STRESS_TASK_COUNT) {
+      return;
+    }
+    state->pool.Submit([state, child]() { NestedTask(state, child); });
+  }
+}
+
+auto StressTest::nested_submit_test(BasePool& pool, uint64_t seed) -> bool {
+  Ledger ledger(STRESS_TASK_COUNT);
+  NestedState state{pool, ledger, seed};
+  for (int i = 0; i < STRESS_ROOT_COUNT; i++) {
+    uint64_t root = state.next_id.fetch_add(1, std::memory_order_relaxed);
+    pool.Submit([&state, root]() { NestedTask(&state, root); });
+  }
+  pool.WaitUntilFinished();
+  size_t expected = std::min<uint64_t>(state.next_id, STRESS_TASK_COUNT);
+  return ledger.Check("nested submit", expected);
+}
+
+/*
+ * STRESS_PRODUCER_COUNT threads submit STRESS_TASK_COUNT tasks in total,
+ * every other producer through the keyed Submit()
+ */
+static void Produce(BasePool& pool, Ledger& ledger, uint64_t seed) {
+  std::vector<std::thread> producers;
+  for (int p = 0; p < STRESS_PRODUCER_COUNT; p++) {
+    producers.emplace_back([&pool, &ledger, seed, p]() {
+      uint64_t begin = STRESS_TASK_COUNT / STRESS_PRODUCER_COUNT * p;
+      uint64_t end = STRESS_TASK_COUNT / STRESS_PRODUCER_COUNT * (p + 1);
+      for (uint64_t id = begin; id < end; id++) {
+        Task task = [&ledger, seed, id]() {
+          Chaos(seed, id);
+          ledger.Hit(id);
+        };
+        if (p % 2 == 0) {
+          pool.Submit(std::move(task));
+        } else {
+          pool.Submit(id % 64, std::move(task));
+        }
+        // the producers race each other at varying speeds too
+        if (Mix(~seed, id) % 64 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+}
+
+auto StressTest::producers_test(BasePool& pool, uint64_t seed) -> bool {
+  Ledger ledger(STRESS_TASK_COUNT);
+  Produce(pool, ledger, seed);
+  pool.WaitUntilFinished();
+  return ledger.Check("producers", STRESS_TASK_COUNT);
+}
+
+auto StressTest::epochs_test(BasePool& pool, uint64_t seed) -> bool {
+  std::atomic<uint64_t> submitted{0};
+  std::atomic<uint64_t> done{0};
+  for (uint64_t epoch = 0; epoch < STRESS_EPOCHS; epoch++) {
+    for (uint64_t i = 0; i < STRESS_TASK_COUNT / STRESS_EPOCHS; i++) {
+      uint64_t id = epoch * STRESS_TASK_COUNT + i;
+      submitted++;
+      pool.Submit([&pool, &submitted, &done, seed, id]() {
+        // a child submitted late in the epoch has to be waited for as well
+        if (Mix(~seed, id) % 4 == 0) {
+          submitted++;
+          pool.Submit([&done, seed, id]() {
+            Chaos(seed, ~id);
+            done++;
+          });
+        }
+        Chaos(seed, id);
+        done++;
+      });
+    }
+    pool.WaitUntilFinished();
+    if (done != submitted) {
+      std::cout << "epochs: epoch " << epoch << " returned with "
+                << submitted - done << " tasks unfinished" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+auto StressTest::steal_test(BasePool& pool, uint64_t seed) -> bool {
+  Ledger ledger(STRESS_TASK_COUNT);
+  // submitted from a worker, the tasks land on that worker's own queue
+  pool.Submit([&pool, &ledger, seed]() {
+    for (uint64_t id = 0; id < STRESS_TASK_COUNT; id++) {
+      pool.Submit([&ledger, seed, id]() {
+        Chaos(seed, id);
+        ledger.Hit(id);
+      });
+      if (id % 256 == 0) {
+        Chaos(~seed, id);
+      }
+    }
+  });
+  pool.WaitUntilFinished();
+  return ledger.Check("steal", STRESS_TASK_COUNT);
+}
+
+auto StressTest::exit_test(const PoolFactory& make, uint64_t seed) -> bool {
+  Ledger ledger(STRESS_TASK_COUNT);
+  std::unique_ptr<BasePool> pool = make();
+  Produce(*pool, ledger, seed);
+  // most tasks are still queued, the workers have to run them before leaving
+  pool->Exit();
+  pool.reset();
+  return ledger.Check("exit under load", STRESS_TASK_COUNT);
+}
+
+auto StressTest::shutdown_test(const PoolFactory& make, uint64_t seed)
+    -> bool {
+  Ledger ledger(STRESS_TASK_COUNT);
+  std::unique_ptr<BasePool> pool = make();
+  Produce(*pool, ledger, seed);
+  pool->Shutdown();
+  pool->Join();
+  uint64_t cancelled = pool->GetCancelledCount();
+  pool.reset();
+  // the queued tasks are abandoned, but none may run twice
+  std::cout << "Shutdown under load: " << ledger.Count() << " of "
+            << STRESS_TASK_COUNT << " tasks run, " << cancelled
+            << " cancelled" << std::endl;
+  // and every one of those not run is accounted for
+  bool counted = cancelled == STRESS_TASK_COUNT - ledger.Count();
+  if (!counted) {
+    std::cout << "shutdown under load: " << STRESS_TASK_COUNT - ledger.Count()
+              << " tasks not run, but " << cancelled << " cancelled"
+              << std::endl;
+  }
+  return ledger.Check("shutdown under load", STRESS_TASK_COUNT, true) &&
+         counted;
+}
+
+auto StressTest::RunPool(const std::string& name, const PoolFactory& make,
+                         uint64_t seed) -> int {
+  std::cout << "Begin stress test on " << name << std::endl;
+  fflush(stdout);
+  int failures = 0;
+  auto check = [&failures, &name](const char* scenario, bool passed) {
+    if (!passed) {
+      std::cout << "FAILED: " << name << " " << scenario << std::endl;
+      failures++;
+    }
+  };
+  Timer timer;
+  {
+    std::unique_ptr<BasePool> pool = make();
+    check("nested submit", nested_submit_test(*pool, seed));
+    check("producers", producers_test(*pool, seed));
+    check("epochs", epochs_test(*pool, seed));
+    check("steal", steal_test(*pool, seed));
+    pool->Exit();
+  }
+  check("exit under load", exit_test(make, seed));
+  check("shutdown under load", shutdown_test(make, seed));
+  std::cout << "Stress test on " << name << ": Timer has elapsed "
+            << timer.Elapsed() << " millis time" << std::endl;
+  fflush(stdout);
+  return failures;
+}
+
+auto StressTest::Run(int rounds, uint64_t seed) -> int {
+  const int workers = STRESS_WORKER_COUNT;
+  std::vector<std::pair<std::string, PoolFactory>> pools = {
+      {"Global Pool",
+       [=]() { return std::make_unique<GlobalPool>(workers, PoolType::STREAM); }},
+      {"Local Coarse Pool",
+       [=]() {
+         return std::make_unique<LocalCoarsePool>(workers, PoolType::STREAM);
+       }},
+      {"Local Fine Pool",
+       [=]() {
+         return std::make_unique<LocalFinePool>(workers, PoolType::STREAM);
+       }},
+      {"Log Steal",
+       [=]() {
+         return std::make_unique<LocalFinePoolLogSteal>(workers,
+                                                        PoolType::STREAM);
+       }},
+      {"Naive Steal",
+       [=]() {
+         return std::make_unique<LocalFinePoolNaiveSteal>(workers,
+                                                          PoolType::STREAM);
+       }},
+      {"Naive Steal LIFO",
+       [=]() {
+         return std::make_unique<LocalFinePoolNaiveSteal>(
+             workers, PoolType::STREAM, StealOrder::LIFO);
+       }},
+      {"Elastic Pool",
+       [=]() {
+         return std::make_unique<ElasticPool>(1, workers, PoolType::STREAM);
+       }},
+      {"Fiber Pool",
+       [=]() { return std::make_unique<FiberPool>(workers, PoolType::STREAM); }},
+      {"Policy Pool",
+       [=]() {
+         return std::make_unique<PoolAdapter<NaiveStealPolicyPool>>(
+             workers, PoolType::STREAM);
+       }},
+      {"Policy Pool, sleeping",
+       [=]() {
+         return std::make_unique<PoolAdapter<GlobalPolicyPool>>(
+             workers, PoolType::STREAM);
+       }},
+  };
+  int failures = 0;
+  for (int round = 0; round < rounds; round++) {
+    std::cout << "Stress round " << round << ", seed " << seed + round
+              << std::endl;
+    for (auto& [name, make] : pools) {
+      failures += RunPool(name, make, seed + round);
+    }
+  }
+  std::cout << "Stress test: " << failures << " checks failed" << std::endl;
+  return failures;
+}
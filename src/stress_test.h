@@ -0,0 +1,68 @@
+/**
+ * @file stress_test.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the stress suite of the threadpools
+ * run it by './run_pool stress [rounds] [seed]', best on a sanitizer build,
+ * see the 'stress' target of the Makefile
+ *
+ * Every scenario hands out task ids and checks that each id has run exactly
+ * once, i.e. no task is lost or duplicated. The checks do not rely on
+ * assert, a failure is reported and counted in any kind of build.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "base_pool.h"
+
+/* few workers, so that the queues are contended and actually stolen from */
+#define STRESS_WORKER_COUNT 8
+#define STRESS_TASK_COUNT 20000
+#define STRESS_ROUNDS 3
+#define STRESS_PRODUCER_COUNT 4
+#define STRESS_EPOCHS 50
+#define STRESS_FANOUT 4
+#define STRESS_ROOT_COUNT 16
+
+/* builds a fresh pool, for the scenarios that stop the pool they are given */
+using PoolFactory = std::function<std::unique_ptr<BasePool>()>;
+
+class StressTest {
+ public:
+  /**
+   * Run every scenario against every pool for several rounds
+   * round r uses seed + r for the randomized yields, sleeps and fan-outs
+   * @return how many checks have failed
+   */
+  static auto Run(int rounds, uint64_t seed) -> int;
+
+  /* tasks submit a random number of children from inside the pool */
+  static auto nested_submit_test(BasePool& pool, uint64_t seed) -> bool;
+
+  /* several external threads submit at once, plain and keyed */
+  static auto producers_test(BasePool& pool, uint64_t seed) -> bool;
+
+  /* WaitUntilFinished() must cover exactly the tasks of its epoch */
+  static auto epochs_test(BasePool& pool, uint64_t seed) -> bool;
+
+  /* one worker submits everything to itself, the others have to steal */
+  static auto steal_test(BasePool& pool, uint64_t seed) -> bool;
+
+  /* Exit() with the queues full still runs every task once */
+  static auto exit_test(const PoolFactory& make, uint64_t seed) -> bool;
+
+  /* Shutdown() with the queues full runs no task twice */
+  static auto shutdown_test(const PoolFactory& make, uint64_t seed) -> bool;
+
+ private:
+  /* run all scenarios against one kind of pool */
+  static auto RunPool(const std::string& name, const PoolFactory& make,
+                      uint64_t seed) -> int;
+};
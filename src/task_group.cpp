@@ -0,0 +1,60 @@
+/**
+ * @file task_group.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the TaskGroup utility
+ */
+
+#include "task_group.h"
+
+#include <utility>
+
+TaskGroup::TaskGroup(BasePool& pool, CancellationToken token)
+    : pool_(pool), token_(std::move(token)) {}
+
+TaskGroup::~TaskGroup() {
+  WaitPending();
+  if (error_) {
+    pool_.ReportError(error_);
+  }
+}
+
+void TaskGroup::Run(Task task) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    pending_++;
+  }
+  pool_.Submit([this, task = std::move(task)]() {
+    // a skipped or failed task still has to leave the group
+    std::exception_ptr error = pool_.RunCapturing(
+        [this, &task]() { pool_.RunUnlessCancelled(task, token_); });
+    // decrement under the mutex: once Wait() sees zero the group may be
+    // destroyed, so nothing of it may be touched after the unlock
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (error && !error_) {
+      error_ = error;
+    }
+    if (--pending_ == 0) {
+      cv_.notify_all();
+    }
+  });
+}
+
+void TaskGroup::Wait() {
+  WaitPending();
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    error.swap(error_);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void TaskGroup::WaitPending() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  cv_.wait(lock, [this]() -> bool { return pending_ == 0; });
+}
@@ -0,0 +1,71 @@
+/**
+ * @file task_group.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the TaskGroup utility
+ * which waits for a set of tasks instead of the whole threadpool
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+#include "base_pool.h"
+#include "cancellation_token.h"
+
+/*
+ * Run tasks on a pool and wait for just those tasks
+ * unlike BasePool::WaitUntilFinished(), other tasks in the pool do not count
+ *
+ * Wait() blocks the calling thread, so it must not be called from a worker
+ * of the same pool, or the pool may run out of workers to finish the group
+ *
+ * Every group has a CancellationToken: once it is cancelled, the tasks of
+ * the group that have not started yet are skipped. A nested group built
+ * on GetToken().CreateChild() is cancelled along with its parent.
+ *
+ * The first exception thrown by a task of the group is rethrown by Wait(),
+ * the others are counted by the pool and dropped.
+ */
+class TaskGroup {
+ public:
+  explicit TaskGroup(BasePool& pool,
+                     CancellationToken token = CancellationToken());
+
+  /*
+   * waits for the outstanding tasks, they may refer to the group
+   * an exception nobody has collected through Wait() goes to the pool's
+   * error handler
+   */
+  ~TaskGroup();
+
+  void Run(Task task);
+
+  /*
+   * block until every task passed to Run() so far has finished or skipped
+   * then rethrow the first exception of those tasks, if any
+   */
+  void Wait();
+
+  /* skip the tasks of this group that have not started yet */
+  void Cancel() { token_.Cancel(); }
+
+  auto GetToken() const -> const CancellationToken& { return token_; }
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+ private:
+  void WaitPending();
+
+  BasePool& pool_;
+  CancellationToken token_;
+  int pending_{0};            // guarded by mtx_
+  std::exception_ptr error_;  // guarded by mtx_
+  std::mutex mtx_;
+  std::condition_variable cv_;
+};
@@ -0,0 +1,51 @@
+/**
+ * @file task_registry.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the TaskRegistry
+ * registrations run during static initialization, before main() starts any
+ * thread, and lookups after it, so the table itself needs no lock
+ */
+
+#include "task_registry.h"
+
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+/* a function-local static, so it exists before any registration uses it */
+auto Table() -> std::unordered_map<uint32_t, RemoteFunction>& {
+  static std::unordered_map<uint32_t, RemoteFunction> table;
+  return table;
+}
+
+}  // namespace
+
+auto TaskRegistry::Register(const char* name, RemoteFunction function)
+    -> uint32_t {
+  uint32_t id = IdOf(name);
+  auto inserted = Table().emplace(id, function);
+  if (!inserted.second && inserted.first->second != function) {
+    throw std::logic_error(std::string("task ID taken, rename task ") + name);
+  }
+  return id;
+}
+
+auto TaskRegistry::Find(uint32_t id) -> RemoteFunction {
+  auto found = Table().find(id);
+  return found == Table().end() ? nullptr : found->second;
+}
+
+/* 32-bit FNV-1a */
+auto TaskRegistry::IdOf(const char* name) -> uint32_t {
+  uint32_t hash = 2166136261u;
+  for (; *name != '\0'; name++) {
+    hash ^= static_cast<unsigned char>(*name);
+    hash *= 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file task_registry.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies the registered task table
+ * a Task is a closure and means nothing outside of the process that made it,
+ * so pools that hand work to other processes ship a function ID plus the
+ * bytes of its argument instead, and every process looks the ID up here
+ *
+ * the ID is a hash of the registered name, so it is the same in every process
+ * running the same program, whatever order the registrations ran in
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* runs in whichever process picked the task up, arg is its own copy */
+using RemoteFunction = void (*)(const char* arg, size_t size);
+
+class TaskRegistry {
+ public:
+  /**
+   * Register function under name, usually from a static initializer
+   * throws std::logic_error when another function already took the ID
+   * @return the ID to submit the function by
+   */
+  static auto Register(const char* name, RemoteFunction function) -> uint32_t;
+
+  /* @return the function registered under id, null if there is none */
+  static auto Find(uint32_t id) -> RemoteFunction;
+
+  /* the ID name is registered under, or would be */
+  static auto IdOf(const char* name) -> uint32_t;
+};
+
+/* register a free function under its own name, at static initialization */
+#define ZORRO_REGISTER_TASK(function)                \
+  static const uint32_t function##_task_id =         \
+      TaskRegistry::Register(#function, function)
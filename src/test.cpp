@@ -4,13 +4,47 @@
 
 #include "test.h"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#ifdef ZORRO_WITH_PSTL
+#include <execution>
+#endif
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <random>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
+#include "cancellation_token.h"
+#include "cluster_pool.h"
 #include "dummy_pool.h"
+#include "fiber_pool.h"
+#include "fine_queue.h"
+#include "parallel_primitives.h"
+#include "parallel_sort.h"
+#include "perf_counters.h"
+#include "policy_pool.h"
+#include "shm_pool.h"
+#include "simd_kernels.h"
+#include "strand.h"
+#include "task_registry.h"
+#include "task_group.h"
 #include "timer.h"
+#include "wire_format.h"
 
 // To disable optimization on light_task
 void light_task() { return; }
@@ -18,7 +52,7 @@ void light_task() { return; }
 uint64_t Test::light_test(BasePool &pool) {
   std::cout << "Begin light test" << std::endl;
   fflush(stdout);
-  Timer timer;
+  PerfTimer timer("Light test");
   for (int i = 0; i < TASK_COUNT_LIGHT; i++) {
     pool.Submit(light_task);
   }
@@ -30,15 +64,417 @@ uint64_t Test::light_test(BasePool &pool) {
   return result;
 }
 
+/* fails on purpose, see policy_test() */
+void policy_failing_task() { throw std::runtime_error("policy test"); }
+
+uint64_t Test::policy_test() {
+  std::cout << "Begin policy test" << std::endl;
+  fflush(stdout);
+  // the light test once more, on a pool typed for plain function pointers
+  Pool<LocalQueues, RingSteal, SpinIdle, NoStats, void (*)()> pool(
+      THREAD_COUNT);
+  PerfTimer timer("Policy test");
+  for (int i = 0; i < TASK_COUNT_LIGHT; i++) {
+    pool.Submit(light_task);
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  // a failure takes the error path of every other pool
+  std::atomic<int> reported{0};
+  pool.SetErrorHandler([&reported](std::exception_ptr) { reported++; });
+  pool.Submit(policy_failing_task);
+  pool.WaitUntilFinished();
+  assert(pool.GetFailedCount() == 1 && reported.load() == 1);
+  std::cout << "Policy test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+/* producers threads push LOCK_TEST_PUSHES tasks into one queue at once */
+template <typename Lock>
+uint64_t time_pushes(int producers) {
+  fine_queue<Task, Lock> queue;
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&queue, &go, producers]() {
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < LOCK_TEST_PUSHES / producers; i++) {
+        queue.push(light_task);
+      }
+    });
+  }
+  Timer timer;
+  go = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  uint64_t result = timer.Elapsed();
+  std::vector<Task> drained;
+  size_t count = 0;
+  while (size_t popped = queue.pop_bulk(drained, 1024)) {
+    count += popped;
+    drained.clear();
+  }
+  assert(count == static_cast<size_t>(LOCK_TEST_PUSHES / producers * producers));
+  return result;
+}
+
+uint64_t Test::lock_test() {
+  std::cout << "Begin lock test" << std::endl;
+  fflush(stdout);
+  Timer timer;
+  std::cout << "producers   std::mutex  TicketLock  McsLock  CombiningLock"
+            << std::endl;
+  for (int producers = 2; producers <= LOCK_TEST_MAX_PRODUCERS;
+       producers *= 2) {
+    std::cout << std::setw(9) << producers << std::setw(13)
+              << time_pushes<std::mutex>(producers) << std::setw(12)
+              << time_pushes<TicketLock>(producers) << std::setw(9)
+              << time_pushes<McsLock>(producers) << std::setw(15)
+              << time_pushes<CombiningLock>(producers) << std::endl;
+  }
+  uint64_t result = timer.Elapsed();
+  std::cout << "Lock test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+/*
+ * The bookkeeping every pool does per task, split over threads: count the
+ * submission, check the status, count the finish, see whether it was the
+ * last one, as CountSubmit(), GetStatus(), CountFinish() and AllFinished()
+ * do with the given orders
+ * @return nanoseconds per task
+ */
+template <std::memory_order Submit, std::memory_order Finish,
+          std::memory_order Load>
+double time_bookkeeping(int threads) {
+  std::atomic<uint64_t> submitted{0};
+  std::atomic<uint64_t> finished{0};
+  std::atomic<PoolStatus> status{PoolStatus::RUNNING};
+  std::atomic<uint64_t> idle{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&, threads]() {
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      uint64_t seen_idle = 0;
+      for (int i = 0; i < ORDER_TEST_TASKS / threads; i++) {
+        submitted.fetch_add(1, Submit);
+        if (status.load(Load) != PoolStatus::RUNNING) {
+          break;
+        }
+        uint64_t done = finished.fetch_add(1, Finish) + 1;
+        seen_idle += done == submitted.load(std::memory_order_relaxed);
+        seen_idle += finished.load(Load) == submitted.load(Load);
+      }
+      idle.fetch_add(seen_idle, std::memory_order_relaxed);
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  go = true;
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double, std::nano> took =
+      std::chrono::steady_clock::now() - start;
+  assert(finished.load() == submitted.load());
+  return took.count() / (ORDER_TEST_TASKS / threads * threads);
+}
+
+uint64_t Test::memory_order_test() {
+  std::cout << "Begin memory order test" << std::endl;
+  fflush(stdout);
+  Timer timer;
+  // before: every access seq_cst; after: the orders of BasePool
+  std::cout << "threads   seq_cst ns/task   acquire/release ns/task"
+            << std::endl;
+  for (int threads = 1; threads <= ORDER_TEST_MAX_THREADS; threads *= 2) {
+    double before =
+        time_bookkeeping<std::memory_order_seq_cst, std::memory_order_seq_cst,
+                         std::memory_order_seq_cst>(threads);
+    double after =
+        time_bookkeeping<std::memory_order_relaxed, std::memory_order_acq_rel,
+                         std::memory_order_acquire>(threads);
+    std::cout << std::setw(7) << threads << std::fixed << std::setprecision(2)
+              << std::setw(18) << before << std::setw(26) << after
+              << std::endl;
+  }
+  std::cout.unsetf(std::ios::fixed);
+  uint64_t result = timer.Elapsed();
+  std::cout << "Memory order test: Timer has elapsed " << result
+            << " millis time" << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+/* lives in the shared area of the pool, so every worker process sees it */
+struct ShmLedger {
+  std::atomic<uint32_t> crashed;
+  std::atomic<uint32_t> hits[TASK_COUNT_SHM];
+};
+
+void shm_hit_task(const char *arg, size_t size) {
+  uint32_t index;
+  assert(size == sizeof(index));
+  memcpy(&index, arg, sizeof(index));
+  auto *ledger = static_cast<ShmLedger *>(ShmPool::SharedArea());
+  ledger->hits[index].fetch_add(1, std::memory_order_relaxed);
+}
+ZORRO_REGISTER_TASK(shm_hit_task);
+
+/* takes its worker process down the first time it runs */
+void shm_crash_task(const char *arg, size_t size) {
+  auto *ledger = static_cast<ShmLedger *>(ShmPool::SharedArea());
+  if (ledger->crashed.exchange(1) == 0) {
+    raise(SIGKILL);
+  }
+  shm_hit_task(arg, size);
+}
+ZORRO_REGISTER_TASK(shm_crash_task);
+
+uint64_t Test::shm_pool_test() {
+  std::cout << "Begin shm pool test" << std::endl;
+  fflush(stdout);
+  ShmPool pool(SHM_WORKER_COUNT, sizeof(ShmLedger));
+  auto *ledger = static_cast<ShmLedger *>(pool.GetSharedArea());
+  PerfTimer timer("Shm pool test");
+  for (uint32_t i = 0; i < TASK_COUNT_SHM; i++) {
+    // one of them kills its worker, the pool has to run it again elsewhere
+    pool.Submit(i == TASK_COUNT_SHM / 2 ? shm_crash_task_task_id
+                                        : shm_hit_task_task_id,
+                i);
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  for (uint32_t i = 0; i < TASK_COUNT_SHM; i++) {
+    assert(ledger->hits[i].load() == 1);
+  }
+  assert(pool.GetFailedCount() == 0);
+  assert(pool.GetRespawnCount() == 1);
+  std::cout << "Shm pool test: " << SHM_WORKER_COUNT
+            << " worker processes, respawned " << pool.GetRespawnCount()
+            << std::endl;
+  std::cout << "Shm pool test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+/* keeps the spin loop from being optimized away */
+std::atomic<uint64_t> cluster_spin_sink{0};
+
+/* burns a known amount of CPU wherever it lands, its argument in wire format */
+void cluster_spin_task(const char *arg, size_t size) {
+  WireReader reader(arg, size);
+  uint64_t spins = reader.GetVarint();
+  uint64_t state = reader.GetVarint();
+  for (uint64_t i = 0; i < spins; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  cluster_spin_sink.store(state, std::memory_order_relaxed);
+}
+ZORRO_REGISTER_TASK(cluster_spin_task);
+
+uint64_t Test::cluster_test() {
+  std::cout << "Begin cluster test" << std::endl;
+  fflush(stdout);
+  ClusterPool pool(CLUSTER_WORKER_COUNT, 0);
+  // the other nodes are this program again, stealing from this one
+  std::string workers = std::to_string(CLUSTER_WORKER_COUNT);
+  std::string seed = "127.0.0.1:" + std::to_string(pool.GetPort());
+  std::vector<pid_t> nodes;
+  for (int i = 1; i < CLUSTER_NODE_COUNT; i++) {
+    char *argv[] = {const_cast<char *>("/proc/self/exe"),
+                    const_cast<char *>(CLUSTER_NODE_ARG),
+                    const_cast<char *>(workers.c_str()),
+                    const_cast<char *>("0"),
+                    const_cast<char *>(seed.c_str()), nullptr};
+    pid_t pid;
+    if (posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv, environ) ==
+        0) {
+      nodes.push_back(pid);
+    }
+  }
+  std::atomic<int> closures{0};
+  PerfTimer timer("Cluster test");
+  for (int i = 0; i < TASK_COUNT_CLUSTER; i++) {
+    pool.Submit(cluster_spin_task_task_id,
+                WireWriter().PutVarint(CLUSTER_SPIN).PutVarint(i).Take());
+    if (i % 100 == 0) {
+      // closures mix in, and stay on this node
+      pool.Submit([&closures]() { closures.fetch_add(1); });
+    }
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  assert(closures.load() == TASK_COUNT_CLUSTER / 100);
+  assert(pool.GetFailedCount() == 0);
+  // a frame longer than CLUSTER_MAX_FRAME gets the connection dropped
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(pool.GetPort());
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ==
+      0) {
+    uint32_t length = CLUSTER_MAX_FRAME + 1;
+    char reply;
+    [[maybe_unused]] ssize_t sent = send(fd, &length, sizeof(length), 0);
+    [[maybe_unused]] ssize_t received = recv(fd, &reply, 1, 0);
+    assert(sent == sizeof(length) && received == 0);
+  }
+  close(fd);
+  std::cout << "Cluster test: " << nodes.size() << " peer nodes ran "
+            << pool.GetRemoteCount() << " of " << TASK_COUNT_CLUSTER
+            << " tasks" << std::endl;
+  for (pid_t pid : nodes) {
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+  }
+  std::cout << "Cluster test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+uint64_t Test::multi_producer_test(BasePool &pool) {
+  std::cout << "Begin multi-producer test" << std::endl;
+  fflush(stdout);
+  PerfTimer timer("Multi-producer test");
+  // same amount of light tasks, submitted from several external threads
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCER_COUNT; p++) {
+    producers.emplace_back([&pool]() {
+      for (int i = 0; i < TASK_COUNT_LIGHT / PRODUCER_COUNT; i++) {
+        pool.Submit(light_task);
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Multi-producer test: Timer has elapsed " << result
+            << " millis time" << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+uint64_t Test::cancellation_test(BasePool &pool) {
+  std::cout << "Begin cancellation test" << std::endl;
+  fflush(stdout);
+  // a request fans out over several branches, each with a child token,
+  // and its client goes away after CANCEL_AFTER tasks
+  CancellationToken request;
+  std::vector<CancellationToken> branches;
+  for (int i = 0; i < CANCELLATION_BRANCHES; i++) {
+    branches.push_back(request.CreateChild());
+  }
+  std::atomic<int> executed{0};
+  uint64_t cancelled_before = pool.GetCancelledCount();
+  PerfTimer timer("Cancellation test");
+  for (int i = 0; i < TASK_COUNT_CANCELLATION; i++) {
+    pool.Submit(
+        [&executed, &request]() {
+          if (executed.fetch_add(1) + 1 == CANCEL_AFTER) {
+            request.Cancel();
+          }
+        },
+        branches[i % CANCELLATION_BRANCHES]);
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  uint64_t cancelled = pool.GetCancelledCount() - cancelled_before;
+  std::cout << "Cancellation test: Timer has elapsed " << result
+            << " millis time, " << executed << " tasks run, " << cancelled
+            << " skipped" << std::endl;
+  fflush(stdout);
+  assert(executed >= CANCEL_AFTER);
+  assert(executed + cancelled == TASK_COUNT_CANCELLATION);
+  return result;
+}
+
+uint64_t Test::exception_test(BasePool &pool) {
+  std::cout << "Begin exception test" << std::endl;
+  fflush(stdout);
+  std::atomic<int> handled{0};
+  pool.SetErrorHandler([&handled](std::exception_ptr) { handled++; });
+  uint64_t failed_before = pool.GetFailedCount();
+  std::atomic<int> succeeded{0};
+  PerfTimer timer("Exception test");
+  // every FAIL_EVERY-th request is bad, the workers must carry on regardless
+  for (int i = 0; i < TASK_COUNT_EXCEPTION; i++) {
+    pool.Submit([i, &succeeded]() {
+      if (i % FAIL_EVERY == 0) {
+        throw std::runtime_error("bad request");
+      }
+      succeeded++;
+    });
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Exception test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(succeeded == TASK_COUNT_EXCEPTION - TASK_COUNT_EXCEPTION / FAIL_EVERY);
+  assert(handled == TASK_COUNT_EXCEPTION / FAIL_EVERY);
+
+  // the exception of a future or a group goes to its owner instead
+  auto good = pool.Async([]() -> int { return 42; });
+  auto bad = pool.Async([]() -> int { throw std::runtime_error("bad"); });
+  assert(good.get() == 42);
+  bool caught = false;
+  try {
+    bad.get();
+  } catch (const std::runtime_error &) {
+    caught = true;
+  }
+  assert(caught);
+  caught = false;
+  try {
+    TaskGroup group(pool);
+    group.Run([]() { throw std::runtime_error("bad"); });
+    group.Run([]() {});
+    group.Wait();
+  } catch (const std::runtime_error &) {
+    caught = true;
+  }
+  assert(caught);
+  assert(handled == TASK_COUNT_EXCEPTION / FAIL_EVERY);
+  assert(pool.GetFailedCount() - failed_before ==
+         TASK_COUNT_EXCEPTION / FAIL_EVERY + 2);
+
+  // a throwing handler is printed, and its task still counts only once
+  pool.SetErrorHandler([](std::exception_ptr error) {
+    std::rethrow_exception(error);
+  });
+  pool.Submit([]() { throw std::runtime_error("bad handler"); });
+  pool.WaitUntilFinished();
+  assert(pool.GetFailedCount() - failed_before ==
+         TASK_COUNT_EXCEPTION / FAIL_EVERY + 3);
+  pool.SetErrorHandler(nullptr);
+  return result;
+}
+
+// the sleeps suspend only the task on a FiberPool, the thread anywhere else
 void normal_task() {
-  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  Fiber::Sleep(std::chrono::milliseconds(50));
   return;
 }
 
 uint64_t Test::normal_test(BasePool &pool) {
   std::cout << "Begin normal test" << std::endl;
   fflush(stdout);
-  Timer timer;
+  PerfTimer timer("Normal test");
   for (int i = 0; i < TASK_COUNT_NORMAL; i++) {
     pool.Submit(normal_task);
   }
@@ -50,8 +486,48 @@ uint64_t Test::normal_test(BasePool &pool) {
   return result;
 }
 
+uint64_t Test::blocking_test(BasePool &pool) {
+  std::cout << "Begin blocking test" << std::endl;
+  fflush(stdout);
+  PerfTimer timer("Blocking test");
+  for (int i = 0; i < TASK_COUNT_NORMAL; i++) {
+    // same sleep as normal_test, but the pool is told the worker blocks
+    pool.Submit([&pool]() { pool.Blocking(normal_task); });
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Blocking test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  return result;
+}
+
+uint64_t Test::fiber_test(BasePool &pool) {
+  std::cout << "Begin fiber test" << std::endl;
+  fflush(stdout);
+  FiberMutex mutex;
+  int counter = 0;
+  PerfTimer timer("Fiber test");
+  for (int i = 0; i < TASK_COUNT_FIBER; i++) {
+    pool.Submit([&mutex, &counter]() {
+      std::lock_guard<FiberMutex> lock(mutex);
+      int seen = counter;
+      // let the other tasks pile up on the mutex in the meantime
+      Fiber::Yield();
+      counter = seen + 1;
+    });
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Fiber test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(counter == TASK_COUNT_FIBER);
+  return result;
+}
+
 void imbalanced_task(int duration) {
-  std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+  Fiber::Sleep(std::chrono::milliseconds(duration));
   return;
 }
 
@@ -76,7 +552,7 @@ uint64_t Test::imbalanced_test(BasePool &pool) {
     }
   }
 
-  Timer timer;
+  PerfTimer timer("Imbalanced test");
   for (int i = 0; i < TASK_COUNT_IMBALANCED; i++) {
     pool.Submit(std::bind(imbalanced_task, durations[i]));
   }
@@ -97,7 +573,7 @@ uint64_t Test::correctness_test(BasePool &pool) {
   for (int i = 0; i < TASK_COUNT_CORRECTNESS; i++) {
     buffer[i] = 0;
   }
-  Timer timer;
+  PerfTimer timer("Correctness test");
   for (int i = 0; i < TASK_COUNT_CORRECTNESS; i++) {
     pool.Submit(std::bind(correctness_test_helper, buffer, i));
   }
@@ -112,6 +588,24 @@ uint64_t Test::correctness_test(BasePool &pool) {
   return result;
 }
 
+// Working set of the recursive tests: tasks spawned but not started yet
+static std::atomic<int> pending_tasks{0};
+static std::atomic<int> peak_pending_tasks{0};
+
+void track_spawn() {
+  int now = pending_tasks.fetch_add(1) + 1;
+  int peak = peak_pending_tasks.load();
+  while (now > peak && !peak_pending_tasks.compare_exchange_weak(peak, now)) {
+  }
+}
+
+void track_start() { pending_tasks.fetch_sub(1); }
+
+void reset_tracking() {
+  pending_tasks.store(0);
+  peak_pending_tasks.store(0);
+}
+
 int partition(int arr[], int start, int end) {
   int pivot = arr[start];
   int count = 0;
@@ -139,19 +633,21 @@ int partition(int arr[], int start, int end) {
 }
 
 void quickSort(int arr[], int start, int end, BasePool *pool) {
+  track_start();
   // base case
   // if (start >= end)
   // return;
-  if (end - start <= QUICK_SORT_THRESHOLD) {
+  if (end - start <= static_cast<int>(pool->GetGrain(QUICK_SORT_THRESHOLD))) {
     std::sort(arr + start, arr + end + 1);
     return;
   }
   // partitioning the array
   int p = partition(arr, start, end);
-  // Sorting the left part
-  pool->Submit(std::bind(quickSort, arr, start, p - 1, pool));
-  // Sorting the right part
-  pool->Submit(std::bind(quickSort, arr, p + 1, end, pool));
+  // Sorting the left part in another task, the right part inline
+  track_spawn();
+  track_spawn();
+  pool->Spawn(std::bind(quickSort, arr, start, p - 1, pool),
+              std::bind(quickSort, arr, p + 1, end, pool));
 }
 
 uint64_t Test::recursion_test(BasePool &pool) {
@@ -163,12 +659,16 @@ uint64_t Test::recursion_test(BasePool &pool) {
     Rand[i] = rand();
     counter += Rand[i];
   }
-  Timer timer;
+  reset_tracking();
+  PerfTimer timer("Recursion test (quick sort)");
+  track_spawn();
   pool.Submit(std::bind(quickSort, Rand, 0, ARRAY_SIZE_RECURSION - 1, &pool));
   pool.WaitUntilFinished();
   uint64_t result = timer.Elapsed();
   std::cout << "Recursion test (quick sort): Timer has elapsed " << result
             << " millis time" << std::endl;
+  std::cout << "Recursion test (quick sort): peak working set "
+            << peak_pending_tasks.load() << " pending tasks" << std::endl;
   fflush(stdout);
   long new_counter = Rand[0];
   for (int i = 0; i < ARRAY_SIZE_RECURSION - 1; i++) {
@@ -186,7 +686,9 @@ uint64_t Test::recursion_test(BasePool &pool) {
 void merge(int arr[], int start, int mid, int end, std::atomic<int> *flag,
            std::atomic<int> *left_flag, std::atomic<int> *right_flag,
            BasePool *pool) {
+  track_start();
   if (*left_flag == 0 || *right_flag == 0) {
+    track_spawn();
     pool->Submit(std::bind(merge, arr, start, mid, end, flag, left_flag,
                            right_flag, pool));
     return;
@@ -231,6 +733,7 @@ void merge(int arr[], int start, int mid, int end, std::atomic<int> *flag,
    sub-array of arr to be sorted */
 void mergeSort(int arr[], int l, int r, BasePool *pool,
                std::atomic<int> *flag) {
+  track_start();
   if (r - l <= MERGE_SORT_THRESHOLD) {
     std::sort(arr + l, arr + r + 1);
     flag->fetch_add(1);
@@ -240,12 +743,17 @@ void mergeSort(int arr[], int l, int r, BasePool *pool,
     // for large l and r
     int m = l + (r - l) / 2;
     // Sort first and second halves
+    // the merge is submitted before the halves so that a LIFO owner
+    // does not keep popping a merge whose halves sit below it in its queue
     std::atomic<int> *left_flag = new std::atomic<int>(0);
-    pool->Submit(std::bind(mergeSort, arr, l, m, pool, left_flag));
     std::atomic<int> *right_flag = new std::atomic<int>(0);
-    pool->Submit(std::bind(mergeSort, arr, m + 1, r, pool, right_flag));
+    track_spawn();
     pool->Submit(
         std::bind(merge, arr, l, m, r, flag, left_flag, right_flag, pool));
+    track_spawn();
+    pool->Submit(std::bind(mergeSort, arr, l, m, pool, left_flag));
+    track_spawn();
+    pool->Submit(std::bind(mergeSort, arr, m + 1, r, pool, right_flag));
   }
 }
 
@@ -258,14 +766,18 @@ uint64_t Test::recursion_test_merge(BasePool &pool) {
     Rand[i] = rand();
     counter += Rand[i];
   }
-  Timer timer;
+  reset_tracking();
+  PerfTimer timer("Recursion test (merge sort)");
   std::atomic<int> *flag = new std::atomic<int>(0);
+  track_spawn();
   pool.Submit(std::bind(mergeSort, Rand, 0, ARRAY_SIZE_RECURSION_MERGE - 1,
                         &pool, flag));
   pool.WaitUntilFinished();
   uint64_t result = timer.Elapsed();
   std::cout << "Recursion test (merge sort): Timer has elapsed " << result
             << " millis time" << std::endl;
+  std::cout << "Recursion test (merge sort): peak working set "
+            << peak_pending_tasks.load() << " pending tasks" << std::endl;
   fflush(stdout);
   long new_counter = Rand[0];
   for (int i = 0; i < ARRAY_SIZE_RECURSION_MERGE - 1; i++) {
@@ -276,4 +788,217 @@ uint64_t Test::recursion_test_merge(BasePool &pool) {
   }
   assert(counter == new_counter);
   return result;
-}
\ No newline at end of file
+}
+
+// Plain counters, a strand must never run two of its tasks at once
+struct StrandCounter {
+  int count = 0;
+  std::atomic<bool> running{false};
+};
+
+void strand_task(StrandCounter *counter, int expected) {
+  bool was_running = counter->running.exchange(true);
+  assert(!was_running);
+  // tasks of one strand also run in the order they were posted
+  assert(counter->count == expected);
+  counter->count++;
+  counter->running.store(false);
+  (void)was_running;
+}
+
+uint64_t Test::strand_test(BasePool &pool) {
+  std::cout << "Begin strand test" << std::endl;
+  fflush(stdout);
+  std::vector<std::unique_ptr<Strand>> strands;
+  std::vector<StrandCounter> counters(STRAND_COUNT);
+  for (int i = 0; i < STRAND_COUNT; i++) {
+    strands.push_back(std::make_unique<Strand>(pool));
+  }
+  PerfTimer timer("Strand test");
+  for (int j = 0; j < TASK_COUNT_PER_STRAND; j++) {
+    for (int i = 0; i < STRAND_COUNT; i++) {
+      strands[i]->Post(std::bind(strand_task, &counters[i], j));
+    }
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Strand test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  for (int i = 0; i < STRAND_COUNT; i++) {
+    assert(counters[i].count == TASK_COUNT_PER_STRAND);
+  }
+  return result;
+}
+
+/*
+ * Run body as a task of pool and wait for it, so the parallel algorithm in
+ * it is called from a worker: it must not wait on blocks of its own then,
+ * the workers they need may all be waiting the same way
+ */
+void run_on_worker(BasePool &pool, const Task &body) {
+  pool.Submit(body);
+  pool.WaitUntilFinished();
+}
+
+uint64_t Test::parallel_sort_test(BasePool &pool) {
+  std::cout << "Begin parallel sort test" << std::endl;
+  fflush(stdout);
+  // on the heap, unlike the recursion tests this size does not fit a stack
+  std::vector<int> data(ARRAY_SIZE_PARALLEL_SORT);
+  for (auto &value : data) {
+    value = rand();
+  }
+  std::vector<int> reference = data;
+  PerfTimer timer("Parallel sort test");
+  ParallelSort(pool, data.begin(), data.end());
+  uint64_t result = timer.Elapsed();
+  std::cout << "Parallel sort test: Timer has elapsed " << result
+            << " millis time" << std::endl;
+
+#ifdef ZORRO_WITH_PSTL
+  std::vector<int> reference_par = reference;
+#endif
+  timer.Reset();
+  std::sort(reference.begin(), reference.end());
+  std::cout << "Parallel sort test: std::sort takes " << timer.Elapsed()
+            << " millis time" << std::endl;
+#ifdef ZORRO_WITH_PSTL
+  timer.Reset();
+  std::sort(std::execution::par, reference_par.begin(), reference_par.end());
+  std::cout << "Parallel sort test: std::sort(std::execution::par) takes "
+            << timer.Elapsed() << " millis time" << std::endl;
+  assert(reference_par == reference);
+#endif
+  fflush(stdout);
+  assert(data == reference);
+
+  std::vector<int> nested(ARRAY_SIZE_NESTED);
+  for (auto &value : nested) {
+    value = rand();
+  }
+  run_on_worker(pool, [&pool, &nested]() {
+    ParallelSort(pool, nested.begin(), nested.end());
+  });
+  assert(std::is_sorted(nested.begin(), nested.end()));
+  std::vector<int> merged(2 * ARRAY_SIZE_NESTED);
+  run_on_worker(pool, [&pool, &nested, &merged]() {
+    ParallelMerge(pool, nested.begin(), nested.end(), nested.begin(),
+                  nested.end(), merged.begin());
+  });
+  assert(std::is_sorted(merged.begin(), merged.end()));
+  return result;
+}
+
+uint64_t Test::scan_test(BasePool &pool) {
+  std::cout << "Begin scan test (" << GetSimdKernels().name << ")"
+            << std::endl;
+  fflush(stdout);
+  std::vector<int> data(ARRAY_SIZE_PRIMITIVES);
+  for (auto &value : data) {
+    value = rand() % 1000;
+  }
+  std::vector<int> output(ARRAY_SIZE_PRIMITIVES);
+  PerfTimer timer("Scan test");
+  ParallelScan(pool, data.data(), output.data(), data.size());
+  uint64_t result = timer.Elapsed();
+  std::cout << "Scan test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+
+  std::vector<int> reference(ARRAY_SIZE_PRIMITIVES);
+  timer.Reset();
+  std::partial_sum(data.begin(), data.end(), reference.begin());
+  std::cout << "Scan test: std::partial_sum takes " << timer.Elapsed()
+            << " millis time" << std::endl;
+  fflush(stdout);
+  assert(output == reference);
+
+  std::vector<int> nested(ARRAY_SIZE_NESTED);
+  run_on_worker(pool, [&pool, &data, &nested]() {
+    ParallelScan(pool, data.data(), nested.data(), nested.size());
+  });
+  assert(std::equal(nested.begin(), nested.end(), reference.begin()));
+  return result;
+}
+
+uint64_t Test::filter_test(BasePool &pool) {
+  std::cout << "Begin filter test (" << GetSimdKernels().name << ")"
+            << std::endl;
+  fflush(stdout);
+  std::vector<int> data(ARRAY_SIZE_PRIMITIVES);
+  for (auto &value : data) {
+    value = rand();
+  }
+  int pivot = RAND_MAX / 2;
+  std::vector<int> output(ARRAY_SIZE_PRIMITIVES);
+  PerfTimer timer("Filter test");
+  size_t kept =
+      ParallelFilter(pool, data.data(), data.size(), pivot, output.data());
+  uint64_t result = timer.Elapsed();
+  std::cout << "Filter test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  output.resize(kept);
+
+  std::vector<int> reference;
+  timer.Reset();
+  std::copy_if(data.begin(), data.end(), std::back_inserter(reference),
+               [pivot](int value) { return value > pivot; });
+  std::cout << "Filter test: std::copy_if takes " << timer.Elapsed()
+            << " millis time" << std::endl;
+  fflush(stdout);
+  assert(output == reference);
+
+  std::vector<int> nested(ARRAY_SIZE_NESTED);
+  size_t nested_kept = 0;
+  run_on_worker(pool, [&pool, &data, &nested, &nested_kept, pivot]() {
+    nested_kept =
+        ParallelFilter(pool, data.data(), nested.size(), pivot, nested.data());
+  });
+  assert(nested_kept == static_cast<size_t>(std::count_if(
+                            data.begin(), data.begin() + ARRAY_SIZE_NESTED,
+                            [pivot](int value) { return value > pivot; })));
+  assert(std::equal(nested.begin(), nested.begin() + nested_kept,
+                    reference.begin()));
+  return result;
+}
+
+uint64_t Test::histogram_test(BasePool &pool) {
+  std::cout << "Begin histogram test (" << GetSimdKernels().name << ")"
+            << std::endl;
+  fflush(stdout);
+  std::vector<int> data(ARRAY_SIZE_PRIMITIVES);
+  for (auto &value : data) {
+    value = rand();
+  }
+  // bin by the top bits that rand() produces, RAND_MAX is 2^31 - 1 on glibc
+  int shift = 31 - HISTOGRAM_BITS;
+  std::vector<uint64_t> hist(1 << HISTOGRAM_BITS);
+  PerfTimer timer("Histogram test");
+  ParallelHistogram(pool, data.data(), data.size(), shift, HISTOGRAM_BITS,
+                    hist.data());
+  uint64_t result = timer.Elapsed();
+  std::cout << "Histogram test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+
+  std::vector<uint64_t> reference(1 << HISTOGRAM_BITS);
+  timer.Reset();
+  for (int value : data) {
+    reference[(value >> shift) & ((1 << HISTOGRAM_BITS) - 1)]++;
+  }
+  std::cout << "Histogram test: serial loop takes " << timer.Elapsed()
+            << " millis time" << std::endl;
+  fflush(stdout);
+  assert(hist == reference);
+
+  std::vector<uint64_t> nested(1 << HISTOGRAM_BITS);
+  run_on_worker(pool, [&pool, &data, &nested, shift]() {
+    ParallelHistogram(pool, data.data(), ARRAY_SIZE_NESTED, shift,
+                      HISTOGRAM_BITS, nested.data());
+  });
+  std::vector<uint64_t> nested_reference(1 << HISTOGRAM_BITS);
+  for (int i = 0; i < ARRAY_SIZE_NESTED; i++) {
+    nested_reference[(data[i] >> shift) & ((1 << HISTOGRAM_BITS) - 1)]++;
+  }
+  assert(nested == nested_reference);
+  return result;
+}
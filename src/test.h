@@ -6,27 +6,95 @@
 #define SRC_TEST_H
 
 #include <cstdint>
+#include <string>
 
 #include "base_pool.h"
 #define TASK_COUNT_LIGHT 100000
+#define PRODUCER_COUNT 8
 #define TASK_COUNT_NORMAL 3000
 #define TASK_COUNT_IMBALANCED 1000
+#define TASK_COUNT_FIBER 10000
+#define TASK_COUNT_CANCELLATION 100000
+#define CANCEL_AFTER 1000
+#define CANCELLATION_BRANCHES 100
+#define TASK_COUNT_EXCEPTION 100000
+#define FAIL_EVERY 100
 #define TASK_COUNT_CORRECTNESS 100000
 #define ARRAY_SIZE_RECURSION 10000000
 #define QUICK_SORT_THRESHOLD 10000
 #define ARRAY_SIZE_RECURSION_MERGE 200000
 #define MERGE_SORT_THRESHOLD 5000
+#define ARRAY_SIZE_PARALLEL_SORT 10000000
+#define ARRAY_SIZE_PRIMITIVES 10000000
+/* called from inside a task, large enough to be split into blocks */
+#define ARRAY_SIZE_NESTED 2000000
+#define HISTOGRAM_BITS 8
+#define STRAND_COUNT 1000
+#define TASK_COUNT_PER_STRAND 100
+#define LOCK_TEST_PUSHES 1000000
+#define LOCK_TEST_MAX_PRODUCERS 128
+#define ORDER_TEST_TASKS 10000000
+#define ORDER_TEST_MAX_THREADS 16
+#define TASK_COUNT_SHM 100000
+#define SHM_WORKER_COUNT 4
+#define TASK_COUNT_CLUSTER 20000
+#define CLUSTER_SPIN 20000
+#define CLUSTER_NODE_COUNT 3
+#define CLUSTER_WORKER_COUNT 4
+#define WORKLOAD_COUNT_SLOTS 256
+#define UTS_SEED 19
+#define UTS_ROOT_CHILDREN 2000
+#define UTS_BRANCH_FACTOR 8
+#define UTS_BRANCH_PROBABILITY 0.12375
+#define FIB_STORM_N 25
+#define MATMUL_SIZE 512
+#define MATMUL_TILE 32
+#define BFS_VERTICES 200000
+#define BFS_DEGREE 8
+#define BFS_CHUNK 1024
+#define SPIN_TASK_COUNT 10000
+#define SPIN_TASK_MICROS 20
+#define TRACE_ROOT_COUNT 64
+#define TRACE_ROOT_MICROS 200
+#define TRACE_FIB_N 15
+#define TRACE_TEST_FILE "/tmp/zorro_trace_test.ztrace"
 
 constexpr static int THREAD_COUNT = 128;
+/* fibers let a handful of workers overlap the sleeping tests */
+constexpr static int FIBER_WORKER_COUNT = 8;
 
 class Test {
  public:
   static uint64_t light_test(BasePool& pool);
+  static uint64_t multi_producer_test(BasePool& pool);
   static uint64_t normal_test(BasePool& pool);
   static uint64_t correctness_test(BasePool& pool);
+  static uint64_t cancellation_test(BasePool& pool);
+  static uint64_t exception_test(BasePool& pool);
   static uint64_t imbalanced_test(BasePool& pool);
   static uint64_t recursion_test(BasePool& pool);
   static uint64_t recursion_test_merge(BasePool& pool);
+  static uint64_t blocking_test(BasePool& pool);
+  static uint64_t fiber_test(BasePool& pool);
+  static uint64_t policy_test();
+  static uint64_t lock_test();
+  static uint64_t memory_order_test();
+  static uint64_t shm_pool_test();
+  static uint64_t cluster_test();
+  static uint64_t strand_test(BasePool& pool);
+  static uint64_t parallel_sort_test(BasePool& pool);
+  static uint64_t scan_test(BasePool& pool);
+  static uint64_t filter_test(BasePool& pool);
+  static uint64_t histogram_test(BasePool& pool);
+  /* the workload suite, see workload_test.cpp */
+  static uint64_t uts_test(BasePool& pool);
+  static uint64_t fib_storm_test(BasePool& pool);
+  static uint64_t matmul_test(BasePool& pool);
+  static uint64_t bfs_test(BasePool& pool);
+  static uint64_t spin_test(BasePool& pool);
+  static uint64_t trace_test(BasePool& pool);
+  /* replay a recorded trace on each of the pools, see trace.h */
+  static void replay_test(const std::string& path);
 };
 
 #endif  // SRC_TEST_H
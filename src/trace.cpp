@@ -0,0 +1,291 @@
+/**
+ * @file trace.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file that implements the trace recorder and
+ * replayer; a record is encoded relative to the one before it and to its
+ * parent, so the varints stay short: the distance to the parent's ID and
+ * how far into the parent's run it was spawned, the submitter, the time since
+ * the previous submission, the queueing time and the run time
+ */
+
+#include "trace.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "busy_work.h"
+#include "timer.h"
+#include "wire_format.h"
+
+namespace {
+
+/* the recorded task the calling thread is running, and for which recorder */
+thread_local const RecordingPool* tls_recorder = nullptr;
+thread_local uint64_t tls_task = TRACE_NO_PARENT;
+/* CPU time of the calling thread when that task started */
+thread_local uint64_t tls_task_cpu = 0;
+
+auto ThreadCpuNanos() -> uint64_t {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+/* submissions from several threads may come slightly out of ID order */
+auto ZigZag(int64_t value) -> uint64_t {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+auto UnZigZag(uint64_t value) -> int64_t {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}  // namespace
+
+auto Trace::Encode() const -> std::string {
+  WireWriter writer;
+  writer.Put<uint32_t>(TRACE_MAGIC).PutVarint(TRACE_VERSION);
+  writer.PutVarint(records.size());
+  uint64_t previous_submit = 0;
+  for (uint64_t id = 0; id < records.size(); id++) {
+    const TraceRecord& record = records[id];
+    writer.PutVarint(record.parent == TRACE_NO_PARENT ? 0 : id - record.parent);
+    if (record.parent != TRACE_NO_PARENT) {
+      writer.PutVarint(record.spawn_ns);
+    }
+    writer.PutVarint(static_cast<uint64_t>(record.submitter + 1));
+    writer.PutVarint(ZigZag(static_cast<int64_t>(record.submit_ns) -
+                            static_cast<int64_t>(previous_submit)));
+    writer.PutVarint(record.start_ns - record.submit_ns);
+    writer.PutVarint(record.run_ns);
+    previous_submit = record.submit_ns;
+  }
+  return writer.Take();
+}
+
+auto Trace::Decode(const std::string& data) -> Trace {
+  Trace trace;
+  try {
+    WireReader reader(data);
+    if (reader.Get<uint32_t>() != TRACE_MAGIC) {
+      throw std::runtime_error("not a trace");
+    }
+    if (reader.GetVarint() != TRACE_VERSION) {
+      throw std::runtime_error("unknown trace version");
+    }
+    uint64_t count = reader.GetVarint();
+    // every record takes 5 bytes at least, do not trust a corrupt count
+    trace.records.reserve(std::min<uint64_t>(count, data.size() / 5));
+    uint64_t previous_submit = 0;
+    for (uint64_t id = 0; id < count; id++) {
+      TraceRecord record;
+      uint64_t distance = reader.GetVarint();
+      if (distance > id) {
+        throw std::runtime_error("trace task spawned before its parent");
+      }
+      if (distance != 0) {
+        record.parent = id - distance;
+        record.spawn_ns = reader.GetVarint();
+      }
+      record.submitter = static_cast<int32_t>(reader.GetVarint()) - 1;
+      record.submit_ns = previous_submit + UnZigZag(reader.GetVarint());
+      record.start_ns = record.submit_ns + reader.GetVarint();
+      record.run_ns = reader.GetVarint();
+      previous_submit = record.submit_ns;
+      trace.records.push_back(record);
+    }
+    if (!reader.AtEnd()) {
+      throw std::runtime_error("trailing bytes after the trace");
+    }
+  } catch (const std::out_of_range&) {
+    throw std::runtime_error("truncated trace");
+  }
+  return trace;
+}
+
+auto Trace::Save(const std::string& path) const -> bool {
+  std::string data = Encode();
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  out.close();
+  return !out.fail();
+}
+
+auto Trace::Load(const std::string& path) -> Trace {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("cannot open trace " + path);
+  }
+  std::ostringstream data;
+  data << in.rdbuf();
+  return Decode(data.str());
+}
+
+auto Trace::Span() const -> uint64_t {
+  if (records.empty()) {
+    return 0;
+  }
+  uint64_t first = UINT64_MAX;
+  uint64_t last = 0;
+  for (auto& record : records) {
+    first = std::min(first, record.submit_ns);
+    last = std::max(last, record.start_ns + record.run_ns);
+  }
+  return last - first;
+}
+
+auto Trace::Work() const -> uint64_t {
+  uint64_t work = 0;
+  for (auto& record : records) {
+    work += record.run_ns;
+  }
+  return work;
+}
+
+RecordingPool::RecordingPool(BasePool& pool)
+    : BasePool(pool.GetConcurrency(), pool.GetType()),
+      pool_(pool),
+      origin_(std::chrono::steady_clock::now()),
+      shards_(new Shard[pool.GetConcurrency() + 1]) {}
+
+void RecordingPool::Submit(Task task) { pool_.Submit(Wrap(std::move(task))); }
+
+void RecordingPool::Submit(uint64_t key, Task task, bool ordered) {
+  pool_.Submit(key, Wrap(std::move(task)), ordered);
+}
+
+auto RecordingPool::GetTrace() -> Trace {
+  Trace trace;
+  trace.records.resize(next_id_.load(std::memory_order_relaxed));
+  for (int i = 0; i <= concurrency_; i++) {
+    std::unique_lock<std::mutex> lock(shards_[i].mtx);
+    for (auto& [id, record] : shards_[i].records) {
+      if (id < trace.records.size()) {
+        trace.records[id] = record;
+      }
+    }
+  }
+  return trace;
+}
+
+void RecordingPool::WakeWorkers() {
+  if (GetStatus() == PoolStatus::SHUTDOWN) {
+    pool_.Shutdown();
+  } else if (GetStatus() == PoolStatus::EXIT) {
+    pool_.Exit();
+  }
+}
+
+auto RecordingPool::Wrap(Task task) -> Task {
+  uint64_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+  TraceRecord record;
+  if (tls_recorder == this) {
+    record.parent = tls_task;
+    record.spawn_ns = ThreadCpuNanos() - tls_task_cpu;
+  }
+  int submitter = pool_.CurrentWorkerId();
+  record.submitter = submitter < 0 ? TRACE_EXTERNAL : submitter;
+  record.submit_ns = Now();
+  return [this, id, record, task = std::move(task)]() mutable {
+    const RecordingPool* outer_recorder = tls_recorder;
+    uint64_t outer_task = tls_task;
+    uint64_t outer_task_cpu = tls_task_cpu;
+    record.start_ns = Now();
+    tls_recorder = this;
+    tls_task = id;
+    tls_task_cpu = ThreadCpuNanos();
+    auto finish = [&]() {
+      record.run_ns = ThreadCpuNanos() - tls_task_cpu;
+      tls_recorder = outer_recorder;
+      tls_task = outer_task;
+      tls_task_cpu = outer_task_cpu;
+      // the worker that ran the task, its shard is hardly ever contended
+      int worker = pool_.CurrentWorkerId();
+      Shard& shard =
+          shards_[worker >= 0 && worker < concurrency_ ? worker : concurrency_];
+      std::unique_lock<std::mutex> lock(shard.mtx);
+      shard.records.emplace_back(id, record);
+    };
+    try {
+      task();
+    } catch (...) {
+      // recorded all the same, the wrapped pool handles the error
+      finish();
+      throw;
+    }
+    finish();
+  };
+}
+
+auto RecordingPool::Now() -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - origin_)
+          .count());
+}
+
+TraceReplayer::TraceReplayer(Trace trace)
+    : trace_(std::move(trace)), children_(trace_.records.size()) {
+  auto& records = trace_.records;
+  for (uint64_t id = 0; id < records.size(); id++) {
+    if (records[id].parent == TRACE_NO_PARENT) {
+      roots_.push_back(id);
+    } else {
+      children_[records[id].parent].push_back(id);
+    }
+  }
+  std::stable_sort(roots_.begin(), roots_.end(),
+                   [&records](uint64_t a, uint64_t b) {
+                     return records[a].submit_ns < records[b].submit_ns;
+                   });
+  for (auto& children : children_) {
+    std::stable_sort(children.begin(), children.end(),
+                     [&records](uint64_t a, uint64_t b) {
+                       return records[a].spawn_ns < records[b].spawn_ns;
+                     });
+  }
+}
+
+auto TraceReplayer::Replay(BasePool& pool) -> uint64_t {
+  run_count_.store(0, std::memory_order_relaxed);
+  BusySpinRate();  // calibrate before the clock starts
+  Timer timer;
+  auto origin = std::chrono::steady_clock::now();
+  uint64_t first =
+      roots_.empty() ? 0 : trace_.records[roots_.front()].submit_ns;
+  for (uint64_t root : roots_) {
+    std::this_thread::sleep_until(
+        origin +
+        std::chrono::nanoseconds(trace_.records[root].submit_ns - first));
+    pool.Submit([this, &pool, root]() { Run(pool, root); });
+  }
+  pool.WaitUntilFinished();
+  return timer.Elapsed();
+}
+
+void TraceReplayer::Run(BasePool& pool, uint64_t id) {
+  const TraceRecord& record = trace_.records[id];
+  // busy up to each spawn, then the rest of the run
+  uint64_t done = 0;
+  for (uint64_t child : children_[id]) {
+    uint64_t at = std::min(trace_.records[child].spawn_ns, record.run_ns);
+    if (at > done) {
+      BusyWork(at - done);
+      done = at;
+    }
+    pool.Submit([this, &pool, child]() { Run(pool, child); });
+  }
+  if (record.run_ns > done) {
+    BusyWork(record.run_ns - done);
+  }
+  run_count_.fetch_add(1, std::memory_order_relaxed);
+}
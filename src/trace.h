@@ -0,0 +1,152 @@
+/**
+ * @file trace.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that specifies workload traces: RecordingPool wraps
+ * a pool and logs for each task when and by whom it was submitted, which
+ * task spawned it and how long it ran, and TraceReplayer plays such a trace
+ * back on any pool, the same spawn tree at the same times, each task busy
+ * for as much CPU time as the recorded one took, so a scheduler change can
+ * be judged on a production task mix without shipping it to production first
+ *
+ * a trace is stored in the format of wire_format.h, about 12 bytes a task;
+ * recording costs a few clock reads per task, it is meant for capturing a
+ * workload, not to be left on
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base_pool.h"
+
+/* the first bytes of a trace file, "ZTRC" */
+#define TRACE_MAGIC 0x4352545aU
+#define TRACE_VERSION 1
+/* submitter of a task submitted from outside the pool's workers */
+#define TRACE_EXTERNAL -1
+/* parent of a task no recorded task spawned */
+#define TRACE_NO_PARENT UINT64_MAX
+
+/* one task, its ID is its index in the trace, in submission order */
+struct TraceRecord {
+  uint64_t parent = TRACE_NO_PARENT;
+  /* worker ID of the submitting thread in the wrapped pool */
+  int32_t submitter = TRACE_EXTERNAL;
+  /* nanoseconds since the recording started */
+  uint64_t submit_ns = 0;
+  uint64_t start_ns = 0;
+  /* CPU time the task ran for, 0 for a task that never did; CPU and not
+   * wall time, which would count the time other threads preempted it */
+  uint64_t run_ns = 0;
+  /* CPU time the parent had run for when it submitted the task */
+  uint64_t spawn_ns = 0;
+
+  auto operator==(const TraceRecord& other) const -> bool {
+    return parent == other.parent && submitter == other.submitter &&
+           submit_ns == other.submit_ns && start_ns == other.start_ns &&
+           run_ns == other.run_ns && spawn_ns == other.spawn_ns;
+  }
+};
+
+struct Trace {
+  std::vector<TraceRecord> records;
+
+  auto Encode() const -> std::string;
+  /* throws std::runtime_error on anything but a trace of this version */
+  static auto Decode(const std::string& data) -> Trace;
+
+  /* @return whether the whole trace was written */
+  auto Save(const std::string& path) const -> bool;
+  /* throws std::runtime_error when the file cannot be read or decoded */
+  static auto Load(const std::string& path) -> Trace;
+
+  /* nanoseconds from the first submission to the last finish */
+  auto Span() const -> uint64_t;
+  /* CPU nanoseconds all the tasks ran, summed */
+  auto Work() const -> uint64_t;
+};
+
+/**
+ * A pool that runs its tasks on another one and records them
+ * the tasks see this pool, so whatever they spawn through it is recorded
+ * too, with them as the parent; failures and the worker IDs stay with the
+ * wrapped pool, which must outlive the recorder and is begun by itself in
+ * BATCH mode
+ */
+class RecordingPool final : public BasePool {
+ public:
+  explicit RecordingPool(BasePool& pool);
+
+  /* keeps the cancellable Submit(task, token) visible */
+  using BasePool::Submit;
+
+  void Submit(Task task) override;
+
+  void Submit(uint64_t key, Task task, bool ordered = false) override;
+
+  void WaitUntilFinished() override { pool_.WaitUntilFinished(); }
+
+  void EnterBlocking() override { pool_.EnterBlocking(); }
+  void LeaveBlocking() override { pool_.LeaveBlocking(); }
+
+  /**
+   * The records so far, a task is only recorded once it has finished, one
+   * not finished yet is left as an external root that never ran
+   * call it after WaitUntilFinished() for a complete trace
+   */
+  auto GetTrace() -> Trace;
+
+ private:
+  /* the records of the tasks finished on one worker */
+  struct alignas(64) Shard {
+    std::mutex mtx;
+    std::vector<std::pair<uint64_t, TraceRecord>> records;  // guarded by mtx
+  };
+
+  void WakeWorkers() override;
+
+  auto Wrap(Task task) -> Task;
+  auto Now() -> uint64_t;
+
+  BasePool& pool_;
+  std::chrono::steady_clock::time_point origin_;
+  std::atomic<uint64_t> next_id_{0};
+  /* one per worker of the wrapped pool, the last for everyone else */
+  std::unique_ptr<Shard[]> shards_;
+};
+
+class TraceReplayer {
+ public:
+  explicit TraceReplayer(Trace trace);
+
+  /**
+   * Play the trace back on pool: the roots are submitted from the calling
+   * thread at their recorded times, every other task by its parent as far
+   * into its run as it was recorded, and each busy-works for its run time
+   * @return the millis until the last of them finished
+   */
+  auto Replay(BasePool& pool) -> uint64_t;
+
+  /* tasks run by the last Replay() */
+  auto GetRunCount() -> uint64_t {
+    return run_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void Run(BasePool& pool, uint64_t id);
+
+  Trace trace_;
+  /* the children of each task, in the order it spawned them */
+  std::vector<std::vector<uint64_t>> children_;
+  std::vector<uint64_t> roots_;
+  std::atomic<uint64_t> run_count_{0};
+};
@@ -0,0 +1,110 @@
+/**
+ * @file wire_format.h
+ * @expectation this header file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is a header file that implements the compact binary format task
+ * arguments and pool messages travel in between processes: integers as
+ * LEB128 varints, byte strings prefixed with their varint length, and
+ * trivially copyable values as their raw bytes, all hosts being Linux
+ * on the same architecture
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+class WireWriter {
+ public:
+  auto PutVarint(uint64_t value) -> WireWriter& {
+    while (value >= 0x80) {
+      buffer_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    buffer_.push_back(static_cast<char>(value));
+    return *this;
+  }
+
+  auto PutBytes(const void* data, size_t size) -> WireWriter& {
+    PutVarint(size);
+    buffer_.append(static_cast<const char*>(data), size);
+    return *this;
+  }
+
+  auto PutString(const std::string& text) -> WireWriter& {
+    return PutBytes(text.data(), text.size());
+  }
+
+  template <typename T>
+  auto Put(const T& value) -> WireWriter& {
+    static_assert(std::is_trivially_copyable_v<T>, "written as raw bytes");
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    return *this;
+  }
+
+  auto Data() const -> const std::string& { return buffer_; }
+
+  /* hand the encoded bytes over, the writer is empty afterwards */
+  auto Take() -> std::string { return std::move(buffer_); }
+
+ private:
+  std::string buffer_;
+};
+
+/* every Get() throws std::out_of_range when the input ends too early */
+class WireReader {
+ public:
+  WireReader(const char* data, size_t size) : at_(data), end_(data + size) {}
+
+  explicit WireReader(const std::string& data)
+      : WireReader(data.data(), data.size()) {}
+
+  auto GetVarint() -> uint64_t {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      Need(1);
+      auto byte = static_cast<uint8_t>(*at_++);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw std::out_of_range("varint longer than 64 bits");
+  }
+
+  auto GetBytes() -> std::string {
+    uint64_t size = GetVarint();
+    Need(size);
+    std::string bytes(at_, size);
+    at_ += size;
+    return bytes;
+  }
+
+  template <typename T>
+  auto Get() -> T {
+    static_assert(std::is_trivially_copyable_v<T>, "read as raw bytes");
+    Need(sizeof(T));
+    T value;
+    memcpy(&value, at_, sizeof(T));
+    at_ += sizeof(T);
+    return value;
+  }
+
+  auto AtEnd() -> bool { return at_ == end_; }
+
+ private:
+  void Need(uint64_t size) {
+    if (size > static_cast<uint64_t>(end_ - at_)) {
+      throw std::out_of_range("truncated wire data");
+    }
+  }
+
+  const char* at_;
+  const char* end_;
+};
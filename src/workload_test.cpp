@@ -0,0 +1,453 @@
+/**
+ * @file workload_test.cpp
+ * @expectation this implementation file should be compatible to compile in C++
+ * program on Linux
+ * @init_date Oct 19 2026
+ *
+ * This is an implementation file for the workload suite of the Test class,
+ * closer to production than empty or sleeping tasks: Unbalanced Tree Search,
+ * a naive fib spawn storm, a cache-tiled matrix multiply, a level-synchronous
+ * BFS and calibrated busy-spin tasks; every test checks its own result
+ *
+ * it also records a workload into a trace and replays it, see trace.h
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "busy_work.h"
+#include "fiber_pool.h"
+#include "global_pool.h"
+#include "local_coarse_pool.h"
+#include "local_fine_pool.h"
+#include "local_fine_pool_log_steal.h"
+#include "local_fine_pool_naive_steal.h"
+#include "perf_counters.h"
+#include "test.h"
+#include "trace.h"
+
+namespace {
+
+/*
+ * A count many workers add to at once, one line per worker so that the
+ * count itself does not become the bottleneck of the workload
+ * the line is picked by worker ID, which every pool binds; a thread that is
+ * not a worker of pool itself, e.g. under a wrapping RecordingPool or
+ * ClusterPool, picks one by its thread ID instead
+ */
+class SpreadCounter {
+ public:
+  void Add(BasePool& pool, uint64_t amount) {
+    int worker = pool.CurrentWorkerId();
+    size_t slot = worker >= 0 ? static_cast<size_t>(worker) : ThreadSlot();
+    slots_[slot % WORKLOAD_COUNT_SLOTS].value.fetch_add(
+        amount, std::memory_order_relaxed);
+  }
+
+  auto Sum() -> uint64_t {
+    uint64_t sum = 0;
+    for (auto& slot : slots_) {
+      sum += slot.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> value{0};
+  };
+  static auto ThreadSlot() -> size_t {
+    thread_local size_t slot =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return slot;
+  }
+
+  Slot slots_[WORKLOAD_COUNT_SLOTS];
+};
+
+auto mix(uint64_t x) -> uint64_t {
+  // splitmix64 finalizer
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/* --- Unbalanced Tree Search, binomial tree --- */
+
+/* a node is its hash, the shape of the tree below follows from it alone */
+auto uts_children(uint64_t node, bool root) -> int {
+  if (root) {
+    return UTS_ROOT_CHILDREN;
+  }
+  double draw = static_cast<double>(mix(node) >> 11) * 0x1.0p-53;
+  return draw < UTS_BRANCH_PROBABILITY ? UTS_BRANCH_FACTOR : 0;
+}
+
+auto uts_child(uint64_t node, int index) -> uint64_t {
+  return mix(node ^
+             (static_cast<uint64_t>(index + 1) * 0x9e3779b97f4a7c15ULL));
+}
+
+void uts_visit(BasePool* pool, SpreadCounter* nodes, uint64_t node, bool root) {
+  nodes->Add(*pool, 1);
+  int children = uts_children(node, root);
+  for (int i = 0; i < children; i++) {
+    uint64_t child = uts_child(node, i);
+    pool->Submit([pool, nodes, child]() {
+      uts_visit(pool, nodes, child, false);
+    });
+  }
+}
+
+auto uts_count_serially(uint64_t root) -> uint64_t {
+  uint64_t count = 0;
+  std::vector<std::pair<uint64_t, bool>> stack{{root, true}};
+  while (!stack.empty()) {
+    auto [node, is_root] = stack.back();
+    stack.pop_back();
+    count++;
+    int children = uts_children(node, is_root);
+    for (int i = 0; i < children; i++) {
+      stack.emplace_back(uts_child(node, i), false);
+    }
+  }
+  return count;
+}
+
+/* --- fib spawn storm --- */
+
+/* fib(n) is the number of leaves with n == 1, each call its own task */
+void fib_spawn(BasePool* pool, SpreadCounter* leaves, int n) {
+  if (n < 2) {
+    leaves->Add(*pool, n);
+    return;
+  }
+  pool->Spawn([pool, leaves, n]() { fib_spawn(pool, leaves, n - 1); },
+              [pool, leaves, n]() { fib_spawn(pool, leaves, n - 2); });
+}
+
+}  // namespace
+
+uint64_t Test::uts_test(BasePool& pool) {
+  std::cout << "Begin UTS test" << std::endl;
+  fflush(stdout);
+  SpreadCounter nodes;
+  PerfTimer timer("UTS test");
+  pool.Submit([&pool, &nodes]() {
+    uts_visit(&pool, &nodes, UTS_SEED, true);
+  });
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  uint64_t expected = uts_count_serially(UTS_SEED);
+  std::cout << "UTS test: " << nodes.Sum() << " nodes, expected " << expected
+            << std::endl;
+  std::cout << "UTS test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(nodes.Sum() == expected);
+  return result;
+}
+
+uint64_t Test::fib_storm_test(BasePool& pool) {
+  std::cout << "Begin fib storm test" << std::endl;
+  fflush(stdout);
+  SpreadCounter leaves;
+  PerfTimer timer("Fib storm test");
+  pool.Submit([&pool, &leaves]() { fib_spawn(&pool, &leaves, FIB_STORM_N); });
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  uint64_t a = 0, b = 1;
+  for (int i = 0; i < FIB_STORM_N; i++) {
+    b += a;
+    a = b - a;
+  }
+  std::cout << "Fib storm test: fib(" << FIB_STORM_N << ") = " << leaves.Sum()
+            << ", expected " << a << std::endl;
+  std::cout << "Fib storm test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(leaves.Sum() == a);
+  return result;
+}
+
+uint64_t Test::matmul_test(BasePool& pool) {
+  std::cout << "Begin matmul test" << std::endl;
+  fflush(stdout);
+  const int n = MATMUL_SIZE;
+  const int tile = MATMUL_TILE;
+  static_assert(MATMUL_SIZE % MATMUL_TILE == 0, "tiles cover the matrix");
+  // small integers, so the check below is exact
+  std::mt19937 random(42);
+  std::vector<int32_t> a(n * n), b(n * n);
+  for (int i = 0; i < n * n; i++) {
+    a[i] = static_cast<int32_t>(random() % 16);
+    b[i] = static_cast<int32_t>(random() % 16);
+  }
+  std::vector<int64_t> c(n * n, 0);
+  PerfTimer timer("Matmul test");
+  // a task per tile of c, walking the k tiles so a, b and c tiles stay hot
+  for (int ti = 0; ti < n; ti += tile) {
+    for (int tj = 0; tj < n; tj += tile) {
+      pool.Submit([&a, &b, &c, n, tile, ti, tj]() {
+        for (int tk = 0; tk < n; tk += tile) {
+          for (int i = ti; i < ti + tile; i++) {
+            for (int k = tk; k < tk + tile; k++) {
+              int64_t aik = a[i * n + k];
+              for (int j = tj; j < tj + tile; j++) {
+                c[i * n + j] += aik * b[k * n + j];
+              }
+            }
+          }
+        }
+      });
+    }
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  // Freivalds: A(Bx) == Cx for random x, in O(n^2) instead of O(n^3)
+  bool correct = true;
+  for (int round = 0; round < 2; round++) {
+    std::vector<int64_t> x(n), bx(n, 0), abx(n, 0), cx(n, 0);
+    for (auto& value : x) {
+      value = static_cast<int64_t>(random() % 2);
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        bx[i] += b[i * n + j] * x[j];
+        cx[i] += c[i * n + j] * x[j];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = 0; j < n; j++) {
+        abx[i] += a[i * n + j] * bx[j];
+      }
+    }
+    correct = correct && abx == cx;
+  }
+  std::cout << "Matmul test: " << n << "x" << n << " in " << tile << "x"
+            << tile << " tiles, " << (correct ? "verified" : "WRONG")
+            << std::endl;
+  std::cout << "Matmul test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(correct);
+  return result;
+}
+
+uint64_t Test::bfs_test(BasePool& pool) {
+  std::cout << "Begin BFS test" << std::endl;
+  fflush(stdout);
+  // a random graph of fixed out-degree, the same on every run
+  const int vertices = BFS_VERTICES;
+  std::mt19937 random(7);
+  std::vector<int> edges(static_cast<size_t>(vertices) * BFS_DEGREE);
+  for (auto& target : edges) {
+    target = static_cast<int>(random() % vertices);
+  }
+  std::unique_ptr<std::atomic<int>[]> level(new std::atomic<int>[vertices]);
+  for (int v = 0; v < vertices; v++) {
+    level[v].store(-1, std::memory_order_relaxed);
+  }
+  level[0].store(0, std::memory_order_relaxed);
+
+  PerfTimer timer("BFS test");
+  // level-synchronous: a task per chunk of the frontier, a wait per level
+  std::vector<int> frontier{0};
+  int depth = 0;
+  for (; !frontier.empty(); depth++) {
+    std::vector<int> next;
+    std::mutex next_mtx;
+    for (size_t start = 0; start < frontier.size(); start += BFS_CHUNK) {
+      pool.Submit([&, start, depth]() {
+        std::vector<int> found;
+        size_t end = std::min(frontier.size(), start + BFS_CHUNK);
+        for (size_t i = start; i < end; i++) {
+          const int* out =
+              &edges[static_cast<size_t>(frontier[i]) * BFS_DEGREE];
+          for (int e = 0; e < BFS_DEGREE; e++) {
+            int expected = -1;
+            // the load skips the locked instruction for visited vertices
+            if (level[out[e]].load(std::memory_order_relaxed) == -1 &&
+                level[out[e]].compare_exchange_strong(
+                    expected, depth + 1, std::memory_order_relaxed)) {
+              found.push_back(out[e]);
+            }
+          }
+        }
+        std::lock_guard<std::mutex> lock(next_mtx);
+        next.insert(next.end(), found.begin(), found.end());
+      });
+    }
+    pool.WaitUntilFinished();
+    frontier.swap(next);
+  }
+  uint64_t result = timer.Elapsed();
+
+  std::vector<int> reference(vertices, -1);
+  std::vector<int> queue{0};
+  reference[0] = 0;
+  for (size_t head = 0; head < queue.size(); head++) {
+    int v = queue[head];
+    for (int e = 0; e < BFS_DEGREE; e++) {
+      int u = edges[static_cast<size_t>(v) * BFS_DEGREE + e];
+      if (reference[u] == -1) {
+        reference[u] = reference[v] + 1;
+        queue.push_back(u);
+      }
+    }
+  }
+  bool correct = true;
+  for (int v = 0; v < vertices; v++) {
+    correct =
+        correct && level[v].load(std::memory_order_relaxed) == reference[v];
+  }
+  std::cout << "BFS test: " << queue.size() << " of " << vertices
+            << " vertices reached in " << depth - 1 << " levels, "
+            << (correct ? "verified" : "WRONG") << std::endl;
+  std::cout << "BFS test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(correct);
+  return result;
+}
+
+uint64_t Test::spin_test(BasePool& pool) {
+  std::cout << "Begin spin test" << std::endl;
+  fflush(stdout);
+  uint64_t iterations = BusySpinRate() * SPIN_TASK_MICROS;
+  SpreadCounter done;
+  PerfTimer timer("Spin test");
+  for (int i = 0; i < SPIN_TASK_COUNT; i++) {
+    pool.Submit([&pool, &done, iterations]() {
+      BusySpin(iterations);
+      done.Add(pool, 1);
+    });
+  }
+  pool.WaitUntilFinished();
+  uint64_t result = timer.Elapsed();
+  std::cout << "Spin test: " << done.Sum() << " tasks of " << SPIN_TASK_MICROS
+            << " us, " << SPIN_TASK_COUNT * SPIN_TASK_MICROS / 1000
+            << " millis of CPU in total" << std::endl;
+  std::cout << "Spin test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(done.Sum() == SPIN_TASK_COUNT);
+  return result;
+}
+
+uint64_t Test::trace_test(BasePool& pool) {
+  std::cout << "Begin trace test" << std::endl;
+  fflush(stdout);
+  // record roots that work a while, then each spawn a fib storm
+  RecordingPool recorder(pool);
+  SpreadCounter leaves;
+  for (int i = 0; i < TRACE_ROOT_COUNT; i++) {
+    recorder.Submit([&recorder, &leaves]() {
+      BusyWork(TRACE_ROOT_MICROS * 1000);
+      fib_spawn(&recorder, &leaves, TRACE_FIB_N);
+    });
+  }
+  recorder.WaitUntilFinished();
+  Trace trace = recorder.GetTrace();
+
+  // every fib call with n >= 2 submits one of its two children
+  std::vector<uint64_t> spawned(TRACE_FIB_N + 1, 0);
+  for (int n = 2; n <= TRACE_FIB_N; n++) {
+    spawned[n] = 1 + spawned[n - 1] + spawned[n - 2];
+  }
+  uint64_t roots = 0;
+  bool correct = trace.records.size() == TRACE_ROOT_COUNT * (1 + spawned.back());
+  for (uint64_t id = 0; id < trace.records.size(); id++) {
+    const TraceRecord& record = trace.records[id];
+    if (record.parent == TRACE_NO_PARENT) {
+      roots++;
+      correct = correct && record.submitter == TRACE_EXTERNAL;
+    } else {
+      // spawned by a running task, so from one of the pool's workers
+      correct = correct && record.parent < id &&
+                record.submit_ns >= trace.records[record.parent].start_ns &&
+                record.submitter >= 0 &&
+                record.submitter < pool.GetConcurrency();
+    }
+    correct = correct && record.start_ns >= record.submit_ns;
+  }
+  correct = correct && roots == TRACE_ROOT_COUNT;
+
+  // through the file and back
+  correct = correct && trace.Save(TRACE_TEST_FILE);
+  Trace loaded = Trace::Load(TRACE_TEST_FILE);
+  correct = correct && loaded.records == trace.records;
+  std::cout << "Trace test: " << trace.records.size() << " tasks recorded in "
+            << trace.Encode().size() << " bytes to " << TRACE_TEST_FILE
+            << ", span " << trace.Span() / 1000000 << " millis, work "
+            << trace.Work() / 1000000 << " millis" << std::endl;
+
+  TraceReplayer replayer(std::move(loaded));
+  uint64_t result;
+  {
+    PerfTimer timer("Trace test");
+    replayer.Replay(pool);
+    result = timer.Elapsed();
+  }
+  correct = correct && replayer.GetRunCount() == trace.records.size();
+  std::cout << "Trace test: replayed " << replayer.GetRunCount() << " tasks, "
+            << (correct ? "correct" : "WRONG") << std::endl;
+  std::cout << "Trace test: Timer has elapsed " << result << " millis time"
+            << std::endl;
+  fflush(stdout);
+  assert(correct);
+  return result;
+}
+
+void Test::replay_test(const std::string& path) {
+  Trace trace = Trace::Load(path);
+  std::cout << "Replaying " << path << ": " << trace.records.size()
+            << " tasks, recorded span " << trace.Span() / 1000000
+            << " millis, work " << trace.Work() / 1000000 << " millis"
+            << std::endl;
+  TraceReplayer replayer(std::move(trace));
+  auto replay = [&replayer](const std::string& name, BasePool& pool) {
+    uint64_t result;
+    {
+      PerfTimer timer(name);
+      replayer.Replay(pool);
+      result = timer.Elapsed();
+    }
+    std::cout << name << ": replayed " << replayer.GetRunCount()
+              << " tasks, Timer has elapsed " << result << " millis time"
+              << std::endl;
+    fflush(stdout);
+  };
+  {
+    GlobalPool pool(THREAD_COUNT, PoolType::STREAM);
+    replay("Global Pool", pool);
+  }
+  {
+    LocalCoarsePool pool(THREAD_COUNT, PoolType::STREAM);
+    replay("Local Coarse Pool", pool);
+  }
+  {
+    LocalFinePool pool(THREAD_COUNT, PoolType::STREAM);
+    replay("Local Fine Pool", pool);
+  }
+  {
+    LocalFinePoolLogSteal pool(THREAD_COUNT, PoolType::STREAM);
+    replay("Log Steal", pool);
+  }
+  {
+    LocalFinePoolNaiveSteal pool(THREAD_COUNT, PoolType::STREAM);
+    replay("Naive Steal", pool);
+  }
+  {
+    FiberPool pool(FIBER_WORKER_COUNT, PoolType::STREAM);
+    replay("Fiber Pool", pool);
+  }
+}